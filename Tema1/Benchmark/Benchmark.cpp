@@ -0,0 +1,878 @@
+#include<bit>
+#include<chrono>
+#include<cstdio>
+#include<iostream>
+#include<optional>
+#include<stack>
+#include<string>
+#include<thread>
+#include<vector>
+
+#include "Corpus.h"
+#include "StageBenchmark.h"
+
+#include "../Tema1/DeterministicFiniteAutomaton.h"
+#include "../Tema1/LazyDeterministicFiniteAutomaton.h"
+#include "../Tema1/BitParallelNfa.h"
+#include "../Tema1/NfaBuilder.h"
+#include "../Tema1/CompilerContext.h"
+#include "../Tema1/CompiledDfa.h"
+#include "../Tema1/CountingNfa.h"
+#include "../Tema1/Matcher.h"
+#include "../Tema1/RegexSet.h"
+#include "../Tema1/RegexParser.h"
+#include "../Tema1/Searcher.h"
+#include "../Tema1/StaticRegex.h"
+#include "../Tema1/ParallelMatcher.h"
+#include "../Tema1/StreamMatcher.h"
+#include "../Tema1/DfaFile.h"
+#include "../Tema1/NondeterministicFiniteAutomaton.h"
+#include "../Tema1/Regex.h"
+
+// Linux: make
+//
+// Benchmark [--stages] [--output <results.jsonl | results.csv>]
+//   --stages  only the per-stage suite, without the engine comparisons
+//   --output  also write every per-stage measurement as JSON lines, or CSV for a .csv file
+
+DeterministicFiniteAutomaton compileRegex(std::string regex)
+{
+	formatRegex(regex);
+	NondeterministicFiniteAutomaton NFA = NFA.returnAFNfromPolishForm(regexToPolishForm(regex));
+	DeterministicFiniteAutomaton DFA = DFA.AFNtoAFD(NFA);
+	return DFA;
+}
+
+template <typename Matcher>
+double timeMatching(const std::vector<std::string>& words, size_t& accepted, Matcher matcher)
+{
+	auto begin = std::chrono::steady_clock::now();
+	accepted = 0;
+	for (const auto& word : words)
+		accepted += matcher(word);
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - begin).count();
+}
+
+void benchmarkCheckWord(const std::string& regex, const std::string& alphabet, size_t length)
+{
+	DeterministicFiniteAutomaton DFA = compileRegex(regex);
+	std::vector<std::string> words = randomWords(alphabet, 200000, length, 42);
+	size_t bytes = words.size() * length;
+
+	size_t accepted_map = 0, accepted_table = 0;
+	double map_ns = timeMatching(words, accepted_map, [&](const std::string& word) { return DFA.CheckWordUsingMap(word); });
+	double table_ns = timeMatching(words, accepted_table, [&](const std::string& word) { return DFA.CheckWord(word); });
+
+	std::cout << regex << " (length " << length << ", " << DFA.getStates().size() << " states)\n";
+	std::cout << "  map   : " << map_ns / bytes << " ns/byte, accepted " << accepted_map << "\n";
+	std::cout << "  table : " << table_ns / bytes << " ns/byte, accepted " << accepted_table << "\n";
+	if (accepted_map != accepted_table)
+		std::cout << "  MISMATCH between map and table results!\n";
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point begin)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void benchmarkEngines(int n)
+{
+	std::string regex = suffixPattern(n);
+	formatRegex(regex);
+	NondeterministicFiniteAutomaton NFA = NFA.returnAFNfromPolishForm(regexToPolishForm(regex));
+	std::vector<std::string> words = randomWords("ab", 20000, 64, 7);
+
+	// the eager construction is exponential in n, only run it while it is still affordable
+	bool eager = n <= 10;
+	DeterministicFiniteAutomaton DFA;
+	double eager_build = 0, eager_match = 0;
+	size_t accepted_eager = 0;
+	auto begin = std::chrono::steady_clock::now();
+	if (eager) {
+		DFA = DFA.AFNtoAFD(NFA);
+		eager_build = elapsedMs(begin);
+		eager_match = timeMatching(words, accepted_eager, [&](const std::string& word) { return DFA.CheckWord(word); });
+	}
+
+	begin = std::chrono::steady_clock::now();
+	LazyDeterministicFiniteAutomaton lazy(NFA);
+	double lazy_build = elapsedMs(begin);
+	size_t accepted_lazy = 0;
+	double lazy_match = timeMatching(words, accepted_lazy, [&](const std::string& word) { return lazy.CheckWord(word); });
+
+	begin = std::chrono::steady_clock::now();
+	BitParallelNfa bit_parallel(NFA);
+	double nfa_build = elapsedMs(begin);
+	BitParallelNfa::Scratch scratch;
+	size_t accepted_nfa = 0;
+	double nfa_match = timeMatching(words, accepted_nfa, [&](const std::string& word) { return bit_parallel.CheckWord(word, scratch); });
+
+	size_t bytes = words.size() * 64;
+	std::cout << "(a|b)*a(a|b){" << n << "}\n";
+	if (eager)
+		std::cout << "  eager : build " << eager_build << " ms, " << DFA.getStates().size() << " states, " << eager_match / bytes << " ns/byte\n";
+	std::cout << "  lazy  : build " << lazy_build << " ms, " << lazy.getCachedStates() << " states cached, " << lazy.getFlushes() << " flushes, " << lazy_match / bytes << " ns/byte\n";
+	std::cout << "  nfa   : build " << nfa_build << " ms, " << bit_parallel.getStateCount() << " NFA states, " << bit_parallel.getPositionCount() << " positions, "
+		<< bit_parallel.getMemoryBytes() / 1024 << " KB, " << nfa_match / bytes << " ns/byte\n";
+	if (accepted_nfa != accepted_lazy)
+		std::cout << "  MISMATCH between bit-parallel NFA and lazy results!\n";
+	if (eager && accepted_eager != accepted_lazy)
+		std::cout << "  MISMATCH between eager and lazy results!\n";
+}
+
+void benchmarkConstruction(const std::string& name, std::string regex)
+{
+	auto begin = std::chrono::steady_clock::now();
+	formatRegex(regex);
+	NondeterministicFiniteAutomaton NFA = NFA.returnAFNfromPolishForm(regexToPolishForm(regex));
+	double nfa_ms = elapsedMs(begin);
+
+	DeterministicFiniteAutomaton DFA = DFA.AFNtoAFD(NFA);
+	const ConstructionTimings& timings = DFA.getConstructionTimings();
+	std::cout << name << " (" << NFA.getStates().size() << " NFA states, " << DFA.getStates().size() << " DFA states)\n";
+	std::cout << "  nfa " << nfa_ms << " ms, closures " << timings.indexMs << " ms, subsets " << timings.subsetMs
+		<< " ms, table " << timings.tableMs << " ms, minimize " << timings.minimizeMs << " ms\n";
+}
+
+// Thompson construction with value-semantics fragments, as returnAFNfromPolishForm used to do it
+NondeterministicFiniteAutomaton legacyThompson(const std::vector<char>& polishForm)
+{
+	typedef NondeterministicFiniteAutomaton nfa;
+	nfa builder;
+	CompilerContext context;
+	std::stack<nfa> automatonStack;
+	for (char token : polishForm)
+	{
+		nfa result;
+		if (token == '.' || token == '|')
+		{
+			nfa a = automatonStack.top();
+			automatonStack.pop();
+			nfa b = automatonStack.top();
+			automatonStack.pop();
+			result = token == '.' ? builder.Concatenate(a, b) : builder.Alternate(a, b, context);
+		}
+		else if (token == '*')
+		{
+			result = builder.KleeneStar(automatonStack.top(), context);
+			automatonStack.pop();
+		}
+		else
+		{
+			int init = context.NewState();
+			int final = context.NewState();
+			result.setInitState(init);
+			result.setFinalState(final);
+			result.addTransition(init, token, final);
+		}
+		automatonStack.push(result);
+	}
+	return automatonStack.top();
+}
+
+void benchmarkNfaBuilder(size_t keywords)
+{
+	std::string regex = keywordAlternation(keywords, 8, 5);
+	size_t length = regex.size();
+
+	auto begin = std::chrono::steady_clock::now();
+	formatRegex(regex);
+	std::vector<char> polishForm = regexToPolishForm(regex);
+	double parse_ms = elapsedMs(begin);
+
+	begin = std::chrono::steady_clock::now();
+	NfaBuilder builder;
+	NfaGraph graph;
+	builder.BuildFromPolishForm(polishForm, graph);
+	double arena_ms = elapsedMs(begin);
+
+	std::cout << "keyword alternation, " << length << " chars (" << graph.stateCount << " states, " << graph.edges.size() << " edges)\n";
+	std::cout << "  parse  : " << parse_ms << " ms\n";
+	std::cout << "  arena  : " << arena_ms << " ms\n";
+
+	// the value-semantics construction is quadratic, keep it to the small inputs
+	if (length <= 5000) {
+		begin = std::chrono::steady_clock::now();
+		NondeterministicFiniteAutomaton legacy = legacyThompson(polishForm);
+		double legacy_ms = elapsedMs(begin);
+		std::cout << "  legacy : " << legacy_ms << " ms (" << legacy.getStates().size() << " states)\n";
+		if (legacy.getStates().size() != (size_t)graph.stateCount)
+			std::cout << "  MISMATCH between legacy and arena state counts!\n";
+	}
+}
+
+void benchmarkCompileAll(size_t rules)
+{
+	std::vector<std::string> regexes;
+	for (size_t i = 0; i < rules; i++)
+		regexes.push_back(keywordAlternation(20, 6, (unsigned)i) + "(a|b)*a(a|b)(a|b)(a|b)");
+
+	auto begin = std::chrono::steady_clock::now();
+	auto serial = CompilerContext::CompileAll(regexes, 1);
+	double serial_ms = elapsedMs(begin);
+
+	begin = std::chrono::steady_clock::now();
+	auto parallel = CompilerContext::CompileAll(regexes);
+	double parallel_ms = elapsedMs(begin);
+
+	size_t compiled = 0;
+	for (size_t i = 0; i < rules; i++)
+		compiled += serial[i].has_value() && parallel[i].has_value()
+			&& serial[i]->getStates().size() == parallel[i]->getStates().size();
+
+	std::cout << rules << " rules compiled\n";
+	std::cout << "  1 thread  : " << serial_ms << " ms\n";
+	std::cout << "  " << std::thread::hardware_concurrency() << " threads : " << parallel_ms << " ms\n";
+	if (compiled != rules)
+		std::cout << "  MISMATCH between serial and parallel compilation!\n";
+}
+
+void benchmarkRegexSet(size_t rules)
+{
+	std::vector<std::string> prefixes = randomWords("abcd", rules, 4, 9);
+	std::vector<std::string> regexes;
+	for (size_t i = 0; i < rules; i++)
+		regexes.push_back(i % 2 ? prefixes[i] + "(a|b|c|d)*" : "(a|b|c|d)*" + prefixes[i]);
+
+	auto dfas = CompilerContext::CompileAll(regexes);
+	RegexSet set;
+	set.Compile(regexes);
+
+	std::vector<std::string> words = randomWords("abcd", 2000, 32, 10);
+	size_t bytes = words.size() * 32;
+	size_t matches_each = 0, matches_set = 0;
+	double each_ns = timeMatching(words, matches_each, [&](const std::string& word) {
+		size_t count = 0;
+		for (auto& dfa : dfas)
+			count += dfa->CheckWord(word);
+		return count;
+	});
+	std::vector<int> patterns;
+	double set_ns = timeMatching(words, matches_set, [&](const std::string& word) {
+		set.Match(word.data(), word.size(), patterns);
+		return patterns.size();
+	});
+
+	std::cout << rules << " rules (" << set.getStateCount() << " set DFA states)\n";
+	std::cout << "  CheckWord per rule : " << each_ns / bytes << " ns/byte, " << matches_each << " matches\n";
+	std::cout << "  RegexSet           : " << set_ns / bytes << " ns/byte, " << matches_set << " matches\n";
+	if (matches_each != matches_set)
+		std::cout << "  MISMATCH between per-rule and set matching!\n";
+}
+
+void benchmarkDfaFile(int n)
+{
+	auto begin = std::chrono::steady_clock::now();
+	DeterministicFiniteAutomaton DFA = compileRegex(suffixPattern(n));
+	double compile_ms = elapsedMs(begin);
+	DFA.SaveBinary("benchmark.dfa");
+
+	MappedDfa mapped;
+	begin = std::chrono::steady_clock::now();
+	mapped.Open("benchmark.dfa", false);
+	double open_ms = elapsedMs(begin);
+	mapped.Close();
+
+	begin = std::chrono::steady_clock::now();
+	mapped.Open("benchmark.dfa", true);
+	double verified_ms = elapsedMs(begin);
+
+	std::vector<std::string> words = randomWords("ab", 20000, 64, 12);
+	size_t accepted_memory = 0, accepted_mapped = 0;
+	timeMatching(words, accepted_memory, [&](const std::string& word) { return DFA.CheckWord(word); });
+	double mapped_ns = timeMatching(words, accepted_mapped, [&](const std::string& word) { return mapped.CheckWord(word); });
+	mapped.Close();
+	std::remove("benchmark.dfa");
+
+	std::cout << "compiled DFA file, (a|b)*a(a|b){" << n << "} (" << DFA.getStates().size() << " states)\n";
+	std::cout << "  compile from regex : " << compile_ms << " ms\n";
+	std::cout << "  map                : " << open_ms << " ms\n";
+	std::cout << "  map and verify     : " << verified_ms << " ms\n";
+	std::cout << "  match mapped       : " << mapped_ns / (words.size() * 64) << " ns/byte\n";
+	if (accepted_memory != accepted_mapped)
+		std::cout << "  MISMATCH between in-memory and mapped DFA!\n";
+}
+
+// reference: restart the anchored DFA at every offset until one matches
+std::vector<SearchMatch> restartingSearch(DeterministicFiniteAutomaton& DFA, const std::string& text)
+{
+	const TransitionTable& table = DFA.getTransitionTable();
+	std::vector<SearchMatch> matches;
+	size_t cursor = 0;
+	while (cursor <= text.size()) {
+		bool found = false;
+		for (size_t begin = cursor; begin <= text.size() && !found; begin++) {
+			int state = table.start;
+			size_t end = begin;
+			for (size_t i = begin;; i++) {
+				if (table.accepting[state]) {
+					end = i;
+					found = true;
+				}
+				if (i == text.size())
+					break;
+				state = table.step(state, (unsigned char)text[i]);
+				if (state == table.dead)
+					break;
+			}
+			if (found) {
+				matches.push_back({ begin, end });
+				cursor = end > begin ? end : begin + 1;
+			}
+		}
+		if (!found)
+			break;
+	}
+	return matches;
+}
+
+void benchmarkSearch(const std::string& regex, const std::string& alphabet, size_t length)
+{
+	std::string text = randomWords(alphabet, 1, length, 13)[0];
+	Searcher searcher;
+	searcher.Compile(regex);
+
+	std::vector<SearchMatch> matches;
+	auto begin = std::chrono::steady_clock::now();
+	searcher.FindAll(text.data(), text.size(), matches);
+	double search_ms = elapsedMs(begin);
+
+	std::cout << "search " << regex << " in " << (length >> 10) << " KB (" << searcher.getForwardStates() << " + "
+		<< searcher.getReverseStates() << " states)\n";
+	std::cout << "  Searcher           : " << search_ms * 1e6 / length << " ns/byte, " << matches.size() << " matches\n";
+
+	if (length > (1 << 16))
+		return;
+	DeterministicFiniteAutomaton DFA = compileRegex(regex);
+	begin = std::chrono::steady_clock::now();
+	std::vector<SearchMatch> expected = restartingSearch(DFA, text);
+	double restart_ms = elapsedMs(begin);
+	std::cout << "  restart per offset : " << restart_ms * 1e6 / length << " ns/byte, " << expected.size() << " matches\n";
+	bool same = expected.size() == matches.size();
+	for (size_t i = 0; same && i < matches.size(); i++)
+		same = expected[i].begin == matches[i].begin && expected[i].end == matches[i].end;
+	if (!same)
+		std::cout << "  MISMATCH between Searcher and restarting search!\n";
+}
+
+void benchmarkPrefilter(const std::string& regex, size_t length)
+{
+	// log-like text: words of letters and digits, rare hits of the pattern
+	std::string text = randomWords("abcdefghijklmnopqrstuvwxyz0123456789     ", 1, length, 14)[0];
+	std::vector<SearchMatch> plain, filtered;
+	Searcher searcher;
+
+	searcher.Compile(regex, false);
+	auto begin = std::chrono::steady_clock::now();
+	searcher.FindAll(text.data(), text.size(), plain);
+	double plain_ms = elapsedMs(begin);
+
+	searcher.Compile(regex, true);
+	begin = std::chrono::steady_clock::now();
+	searcher.FindAll(text.data(), text.size(), filtered);
+	double filtered_ms = elapsedMs(begin);
+
+	const Prefilter& prefilter = searcher.getPrefilter();
+	std::cout << "prefilter " << regex << " in " << (length >> 20) << " MB (prefix \"" << prefilter.getPrefix() << "\", "
+		<< prefilter.getLeadingByteCount() << " leading bytes)\n";
+	std::cout << "  two passes         : " << plain_ms * 1e6 / length << " ns/byte, " << plain.size() << " matches\n";
+	std::cout << "  prefiltered        : " << filtered_ms * 1e6 / length << " ns/byte, " << filtered.size() << " matches\n";
+	bool same = plain.size() == filtered.size();
+	for (size_t i = 0; same && i < plain.size(); i++)
+		same = plain[i].begin == filtered[i].begin && plain[i].end == filtered[i].end;
+	if (!same)
+		std::cout << "  MISMATCH between prefiltered and two-pass search!\n";
+}
+
+template <FixedString Pattern>
+void benchmarkStaticRegex(const std::string& alphabet, size_t length)
+{
+	std::string regex(Pattern.view());
+	auto begin = std::chrono::steady_clock::now();
+	DeterministicFiniteAutomaton DFA = compileRegex(regex);
+	double compile_ms = elapsedMs(begin);
+
+	std::vector<std::string> words = randomWords(alphabet, 200000, length, 15);
+	size_t accepted_runtime = 0, accepted_static = 0;
+	double runtime_ns = timeMatching(words, accepted_runtime, [&](const std::string& word) { return DFA.CheckWord(word); });
+	double static_ns = timeMatching(words, accepted_static, [](const std::string& word) { return StaticRegex<Pattern>::CheckWord(word); });
+
+	std::cout << "static " << regex << " (" << StaticRegex<Pattern>::kStates << " states, runtime compile " << compile_ms << " ms)\n";
+	std::cout << "  runtime CheckWord  : " << runtime_ns / (words.size() * length) << " ns/byte, " << accepted_runtime << " accepted\n";
+	std::cout << "  StaticRegex        : " << static_ns / (words.size() * length) << " ns/byte, " << accepted_static << " accepted\n";
+	if (accepted_runtime != accepted_static)
+		std::cout << "  MISMATCH between runtime and static regex!\n";
+}
+
+void benchmarkByteClasses(const std::string& regex, const std::string& spelled_out, const std::string& alphabet, size_t length)
+{
+	DeterministicFiniteAutomaton classes;
+	DeterministicFiniteAutomaton alternation;
+	CompilerContext context;
+	auto begin = std::chrono::steady_clock::now();
+	context.CompileDfa(regex, classes);
+	double classes_ms = elapsedMs(begin);
+	begin = std::chrono::steady_clock::now();
+	context.CompileDfa(spelled_out, alternation);
+	double alternation_ms = elapsedMs(begin);
+
+	std::vector<std::string> words = randomWords(alphabet, 200000, length, 23);
+	size_t bytes = words.size() * length;
+	size_t accepted_classes = 0, accepted_alternation = 0;
+	double classes_ns = timeMatching(words, accepted_classes, [&](const std::string& word) { return classes.CheckWord(word); });
+	double alternation_ns = timeMatching(words, accepted_alternation, [&](const std::string& word) { return alternation.CheckWord(word); });
+
+	auto describe = [](DeterministicFiniteAutomaton& DFA) {
+		const TransitionTable& table = DFA.getTransitionTable();
+		return std::to_string(table.dead) + " states x " + std::to_string(table.columnCount) + " columns, "
+			+ std::to_string(table.next.size() * sizeof(int)) + " bytes";
+	};
+	std::cout << "classes " << regex << " (" << describe(classes) << ")\n";
+	std::cout << "  class       : compile " << classes_ms << " ms, " << classes_ns / bytes << " ns/byte, " << accepted_classes << " accepted\n";
+	std::cout << "  alternation : compile " << alternation_ms << " ms, " << alternation_ns / bytes << " ns/byte, " << accepted_alternation
+		<< " accepted (" << describe(alternation) << ")\n";
+	if (accepted_classes != accepted_alternation)
+		std::cout << "  MISMATCH between class and alternation!\n";
+}
+
+void benchmarkInterleaved(int n, size_t length)
+{
+	CompilerContext context;
+	DeterministicFiniteAutomaton DFA;
+	context.CompileDfa(suffixPattern(n), DFA);
+	const TransitionTable& table = DFA.getTransitionTable();
+
+	std::vector<std::string> words = suffixWords(n, (32 << 20) / length, length, 0.5, 31);
+	std::vector<std::string_view> views(words.begin(), words.end());
+	size_t bytes = words.size() * length;
+
+	size_t accepted_single = 0;
+	double single_ns = timeMatching(words, accepted_single, [&](const std::string& word) { return DFA.CheckWord(word); });
+
+	std::vector<uint64_t> verdicts;
+	auto begin = std::chrono::steady_clock::now();
+	DFA.CheckWords(views, verdicts);
+	double interleaved_ns = elapsedMs(begin) * 1e6;
+	size_t accepted_interleaved = 0;
+	for (uint64_t bits : verdicts)
+		accepted_interleaved += std::popcount(bits);
+
+	std::cout << "interleaved " << suffixPattern(n) << " (" << table.dead << " states, "
+		<< (table.next.size() * sizeof(int) >> 10) << " KB table, length " << length << ")\n";
+	std::cout << "  CheckWord          : " << single_ns / bytes << " ns/byte, " << accepted_single << " accepted\n";
+	std::cout << "  CheckWords x" << TransitionTableView::kStreams << "      : " << interleaved_ns / bytes << " ns/byte, "
+		<< accepted_interleaved << " accepted\n";
+	if (accepted_single != accepted_interleaved)
+		std::cout << "  MISMATCH between CheckWord and CheckWords!\n";
+}
+
+void benchmarkStream(int n, size_t length, size_t chunk)
+{
+	CompilerContext context;
+	DeterministicFiniteAutomaton DFA;
+	context.CompileDfa(suffixPattern(n), DFA);
+	std::vector<std::string> words = suffixWords(n, (16 << 20) / length, length, 0.5, 37);
+	size_t bytes = words.size() * length;
+
+	size_t accepted_whole = 0, accepted_stream = 0;
+	double whole_ns = timeMatching(words, accepted_whole, [&](const std::string& word) { return DFA.CheckWord(word); });
+	StreamMatcher stream(DFA.getTransitionTable().view());
+	double stream_ns = timeMatching(words, accepted_stream, [&](const std::string& word) {
+		stream.Reset();
+		for (size_t i = 0; i < word.size() && stream.Feed(word.data() + i, std::min(chunk, word.size() - i)); i += chunk);
+		return stream.isAccepting();
+	});
+
+	std::cout << "stream " << suffixPattern(n) << " (length " << length << ", chunks of " << chunk << ")\n";
+	std::cout << "  CheckWord          : " << whole_ns / bytes << " ns/byte, " << accepted_whole << " accepted\n";
+	std::cout << "  StreamMatcher      : " << stream_ns / bytes << " ns/byte, " << accepted_stream << " accepted\n";
+	if (accepted_whole != accepted_stream)
+		std::cout << "  MISMATCH between CheckWord and StreamMatcher!\n";
+}
+
+void benchmarkParallel(const std::string& regex, const std::string& alphabet, size_t length)
+{
+	CompilerContext context;
+	DeterministicFiniteAutomaton DFA;
+	context.CompileDfa(regex, DFA);
+	TransitionTableView table = DFA.getTransitionTable().view();
+	std::string text = randomWords(alphabet, 1, length, 41)[0];
+
+	auto begin = std::chrono::steady_clock::now();
+	bool sequential = table.CheckWord(text.data(), text.size());
+	double sequential_ms = elapsedMs(begin);
+
+	std::cout << "parallel " << regex << " (" << table.dead << " states, " << (length >> 20) << " MB)\n";
+	std::cout << "  CheckWord          : " << sequential_ms << " ms, " << (sequential ? "accepted" : "rejected") << "\n";
+	for (unsigned threads : { 2u, 4u, 8u }) {
+		ParallelMatcher matcher(table, threads);
+		begin = std::chrono::steady_clock::now();
+		bool parallel = matcher.CheckWord(text);
+		double parallel_ms = elapsedMs(begin);
+		std::cout << "  " << threads << " threads          : " << parallel_ms << " ms, " << (parallel ? "accepted" : "rejected") << "\n";
+		if (parallel != sequential)
+			std::cout << "  MISMATCH between sequential and parallel matching!\n";
+	}
+}
+
+void benchmarkParser(const std::string& name, const std::string& regex)
+{
+	NfaBuilder builder;
+	NfaGraph polish_graph, ast_graph;
+	auto begin = std::chrono::steady_clock::now();
+	std::string formatted = regex;
+	bool valid = isValidRegex(formatted);
+	formatRegex(formatted);
+	std::vector<char> polish;
+	regexToPolishForm(formatted, polish);
+	valid = valid && builder.BuildFromPolishForm(polish, polish_graph);
+	double polish_ms = elapsedMs(begin);
+
+	RegexParser parser;
+	RegexAst ast;
+	begin = std::chrono::steady_clock::now();
+	bool parsed = parser.Parse(regex, ast);
+	double parse_ms = elapsedMs(begin);
+	parsed = parsed && builder.BuildFromAst(ast, ast_graph);
+	double ast_ms = elapsedMs(begin);
+
+	std::cout << "parser " << name << " (" << (regex.size() >> 10) << " KB, " << ast.nodes.size() << " AST nodes)\n";
+	std::cout << "  validate + format + polish + build : " << polish_ms << " ms, " << polish_graph.stateCount << " NFA states\n";
+	std::cout << "  RegexParser + BuildFromAst         : " << ast_ms << " ms (parse " << parse_ms << " ms), "
+		<< ast_graph.stateCount << " NFA states\n";
+	if (valid != parsed || polish_graph.stateCount != ast_graph.stateCount || polish_graph.edges.size() != ast_graph.edges.size())
+		std::cout << "  MISMATCH between the two pipelines!\n";
+}
+
+void benchmarkCompiledDfa(int n)
+{
+	CompilerContext context;
+	DeterministicFiniteAutomaton DFA;
+	context.CompileDfa(suffixPattern(n), DFA);
+	std::optional<CompiledDfa> compiled = CompiledDfa::Freeze(DFA);
+	std::vector<std::string> words = suffixWords(n, 2000, 32, 0.5, 47);
+
+	size_t accepted_verified = 0, accepted_frozen = 0;
+	double verified_ns = timeMatching(words, accepted_verified, [&](const std::string& word) { return DFA.VerifyAutomation() && DFA.CheckWord(word); });
+	double frozen_ns = timeMatching(words, accepted_frozen, [&](const std::string& word) { return compiled->CheckWord(word); });
+
+	std::cout << "frozen " << suffixPattern(n) << " (" << compiled->getStateCount() << " states, 32-byte queries)\n";
+	std::cout << "  VerifyAutomation + CheckWord : " << verified_ns / words.size() << " ns/query, " << accepted_verified << " accepted\n";
+	std::cout << "  CompiledDfa::CheckWord       : " << frozen_ns / words.size() << " ns/query, " << accepted_frozen << " accepted\n";
+	if (accepted_verified != accepted_frozen)
+		std::cout << "  MISMATCH between the DFA and its frozen copy!\n";
+}
+
+void benchmarkGlushkov(const std::string& name, const std::string& regex, const std::vector<std::string>& words)
+{
+	size_t bytes = 0;
+	for (const auto& word : words)
+		bytes += word.size();
+
+	std::cout << "construction " << name << "\n";
+	size_t reference = 0;
+	for (NfaConstruction construction : { NfaConstruction::Thompson, NfaConstruction::Glushkov }) {
+		CompilerContext context;
+		context.setConstruction(construction);
+		NfaGraph graph;
+		auto begin = std::chrono::steady_clock::now();
+		context.CompileNfa(regex, graph);
+		double build_ms = elapsedMs(begin);
+
+		size_t lambda_edges = 0;
+		for (const NfaEdge& edge : graph.edges)
+			lambda_edges += edge.symbol == NfaGraph::kLambda;
+
+		begin = std::chrono::steady_clock::now();
+		IndexedNfa indexed(graph);
+		std::vector<std::vector<int>> subsets;
+		std::vector<int> next;
+		indexed.Determinize(subsets, next);
+		double subset_ms = elapsedMs(begin);
+
+		BitParallelNfa simulation(indexed);
+		BitParallelNfa::Scratch scratch;
+		size_t accepted = 0;
+		double simulation_ns = timeMatching(words, accepted, [&](const std::string& word) { return simulation.CheckWord(word, scratch); });
+
+		bool thompson = construction == NfaConstruction::Thompson;
+		std::cout << (thompson ? "  Thompson : " : "  Glushkov : ") << graph.stateCount << " states, " << graph.edges.size() << " edges ("
+			<< lambda_edges << " lambda), build " << build_ms << " ms, subsets " << subset_ms << " ms (" << subsets.size()
+			<< " DFA states), NFA simulation " << simulation_ns / bytes << " ns/byte, " << accepted << " accepted\n";
+		if (thompson)
+			reference = accepted;
+		else if (accepted != reference)
+			std::cout << "  MISMATCH between Thompson and Glushkov!\n";
+	}
+}
+
+void benchmarkNfaReduction(const std::string& name, const std::string& regex, const std::vector<std::string>& words)
+{
+	size_t bytes = 0;
+	for (const auto& word : words)
+		bytes += word.size();
+
+	std::cout << "reduction " << name << "\n";
+	for (NfaConstruction construction : { NfaConstruction::Thompson, NfaConstruction::Glushkov }) {
+		size_t reference = 0;
+		for (bool reduce : { false, true }) {
+			CompilerContext context;
+			context.setConstruction(construction);
+			context.setReduceNfa(reduce);
+			NfaGraph graph;
+			auto begin = std::chrono::steady_clock::now();
+			context.CompileNfa(regex, graph);
+			double build_ms = elapsedMs(begin);
+
+			begin = std::chrono::steady_clock::now();
+			IndexedNfa indexed(graph);
+			std::vector<std::vector<int>> subsets;
+			std::vector<int> next;
+			indexed.Determinize(subsets, next);
+			double subset_ms = elapsedMs(begin);
+
+			BitParallelNfa simulation(indexed);
+			BitParallelNfa::Scratch scratch;
+			size_t accepted = 0;
+			double simulation_ns = timeMatching(words, accepted, [&](const std::string& word) { return simulation.CheckWord(word, scratch); });
+
+			std::cout << (construction == NfaConstruction::Thompson ? "  Thompson" : "  Glushkov") << (reduce ? " reduced : " : "         : ")
+				<< graph.stateCount << " states, " << graph.edges.size() << " edges";
+			if (reduce)
+				std::cout << " (" << context.getReduction().mergedStates << " merged)";
+			std::cout << ", build " << build_ms << " ms, subsets " << subset_ms << " ms (" << subsets.size() << " DFA states), NFA simulation "
+				<< simulation_ns / bytes << " ns/byte, " << accepted << " accepted\n";
+			if (!reduce)
+				reference = accepted;
+			else if (accepted != reference)
+				std::cout << "  MISMATCH between the reduced and the unreduced NFA!\n";
+		}
+	}
+}
+
+void benchmarkRepetition(const std::string& regex, const std::vector<std::string>& words)
+{
+	size_t bytes = 0;
+	for (const auto& word : words)
+		bytes += word.size();
+
+	std::cout << "repetition " << regex << "\n";
+	size_t reference = 0;
+	for (NfaConstruction construction : { NfaConstruction::Thompson, NfaConstruction::Glushkov }) {
+		CompilerContext context;
+		context.setConstruction(construction);
+		NfaGraph graph;
+		auto begin = std::chrono::steady_clock::now();
+		context.CompileNfa(regex, graph);
+		double build_ms = elapsedMs(begin);
+
+		begin = std::chrono::steady_clock::now();
+		IndexedNfa indexed(graph);
+		DeterministicFiniteAutomaton DFA = DFA.AFNtoAFD(indexed);
+		double dfa_ms = elapsedMs(begin);
+
+		BitParallelNfa simulation(indexed);
+		BitParallelNfa::Scratch scratch;
+		size_t accepted = 0, dfa_accepted = 0;
+		double simulation_ns = timeMatching(words, accepted, [&](const std::string& word) { return simulation.CheckWord(word, scratch); });
+		double dfa_ns = timeMatching(words, dfa_accepted, [&](const std::string& word) { return DFA.CheckWord(word); });
+
+		bool thompson = construction == NfaConstruction::Thompson;
+		std::cout << (thompson ? "  Thompson : " : "  Glushkov : ") << graph.stateCount << " states, " << graph.edges.size() << " edges, build "
+			<< build_ms << " ms, DFA " << dfa_ms << " ms (" << DFA.getStates().size() << " states) " << dfa_ns / bytes
+			<< " ns/byte, NFA simulation " << simulation_ns / bytes << " ns/byte, " << accepted << " accepted\n";
+		if (thompson)
+			reference = dfa_accepted;
+		if (accepted != reference || dfa_accepted != reference)
+			std::cout << "  MISMATCH between the DFA and the NFA simulation!\n";
+	}
+
+	// a single-byte operand stays one position with a counter
+	CountingNfa counting;
+	CountingNfa::Scratch scratch;
+	auto begin = std::chrono::steady_clock::now();
+	counting.Compile(regex);
+	double build_ms = elapsedMs(begin);
+	size_t accepted = 0;
+	double counting_ns = timeMatching(words, accepted, [&](const std::string& word) { return counting.CheckWord(word, scratch); });
+	std::cout << "  Counting : " << counting.getPositionCount() << " positions, " << counting.getCounterBits() << " counter bits, build "
+		<< build_ms << " ms, " << counting_ns / bytes << " ns/byte, " << accepted << " accepted\n";
+	if (accepted != reference)
+		std::cout << "  MISMATCH between the DFA and the counting NFA!\n";
+
+	// what the Dfa engine does with a 20 ms budget: the counted repetitions are its fallback
+	CompileBudget budget;
+	budget.maxMs = 20;
+	budget.fallback = true;
+	begin = std::chrono::steady_clock::now();
+	Matcher matcher(regex, MatchEngine::Dfa, budget);
+	double matcher_ms = elapsedMs(begin);
+	double matcher_ns = timeMatching(words, accepted, [&](const std::string& word) { return matcher.CheckWord(word); });
+	const char* engine = matcher.getEngine() == MatchEngine::Dfa ? "DFA" : matcher.getEngine() == MatchEngine::CountingNfa ? "counting NFA" : "NFA";
+	std::cout << "  Matcher  : " << matcher_ms << " ms to compile, " << engine << ", " << matcher_ns / bytes << " ns/byte, " << accepted << " accepted\n";
+	if (accepted != reference)
+		std::cout << "  MISMATCH between the DFA and the budgeted matcher!\n";
+}
+
+void benchmarkBudget(int n, const std::string& name, CompileBudget budget)
+{
+	std::string regex = suffixPattern(n);
+	CompilerContext context;
+	context.setBudget(budget);
+	DeterministicFiniteAutomaton DFA;
+	auto begin = std::chrono::steady_clock::now();
+	bool compiled = context.CompileDfa(regex, DFA);
+	double compile_ms = elapsedMs(begin);
+
+	std::cout << "(a|b)*a(a|b){" << n << "}, budget " << name << "\n";
+	if (compiled)
+		std::cout << "  compiled in " << compile_ms << " ms, " << DFA.getStates().size() << " states\n";
+	else
+		std::cout << "  aborted after " << compile_ms << " ms: " << context.getBudgetError().describe() << "\n";
+
+	// the Matcher falls back to the NFA simulation instead
+	budget.fallback = true;
+	begin = std::chrono::steady_clock::now();
+	Matcher matcher(regex, MatchEngine::Dfa, budget);
+	double matcher_ms = elapsedMs(begin);
+
+	formatRegex(regex);
+	NondeterministicFiniteAutomaton NFA = NFA.returnAFNfromPolishForm(regexToPolishForm(regex));
+
+	std::vector<std::string> words = suffixWords(n, 20000, 64, 0.5, 79);
+	BitParallelNfa reference(NFA);
+	BitParallelNfa::Scratch scratch;
+	size_t accepted = 0, expected = 0;
+	double match_ns = timeMatching(words, accepted, [&](const std::string& word) { return matcher.CheckWord(word); });
+	timeMatching(words, expected, [&](const std::string& word) { return reference.CheckWord(word, scratch); });
+	bool fell_back = matcher.getEngine() == MatchEngine::BitParallelNfa;
+	std::cout << "  matcher : " << matcher_ms << " ms to compile, " << (fell_back ? "fell back to the NFA, " : "DFA, ")
+		<< match_ns / (words.size() * 64) << " ns/byte, " << accepted << " accepted\n";
+	if (accepted != expected)
+		std::cout << "  MISMATCH between the budgeted matcher and the NFA!\n";
+}
+
+// (c|d|...) for every byte of symbols
+std::string alternationOf(const std::string& symbols)
+{
+	std::string alternation = "(";
+	for (char symbol : symbols) {
+		if (alternation.size() > 1)
+			alternation += '|';
+		alternation += symbol;
+	}
+	return alternation + ")";
+}
+
+int main(int argc, char* argv[])
+{
+	bool stages_only = false;
+	BenchmarkReport report;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		if (argument == "--stages")
+			stages_only = true;
+		else if (argument == "--output" && i + 1 < argc) {
+			if (!report.Open(argv[++i]))
+				return 1;
+		}
+		else {
+			std::cout << "Usage: Benchmark [--stages] [--output <results.jsonl | results.csv>]\n";
+			return 1;
+		}
+	}
+
+	benchmarkStages(report);
+	if (stages_only)
+		return 0;
+
+	benchmarkCheckWord("(a|b)*abb", "ab", 64);
+	benchmarkCheckWord("(a|b)*a(a|b)(a|b)(a|b)", "ab", 64);
+	benchmarkCheckWord("aba(aa|bb)*c(ab)*", "abc", 16);
+	benchmarkCheckWord("(ab|ba|aa|bb)*", "ab", 256);
+
+	benchmarkConstruction("100 keywords of 8 letters", keywordAlternation(100, 8, 3));
+	benchmarkConstruction("(a|b)*a(a|b){12}", suffixPattern(12));
+
+	for (size_t keywords : { 200, 2000, 11000, 111000 })
+		benchmarkNfaBuilder(keywords);
+
+	benchmarkCompileAll(2000);
+	benchmarkDfaFile(12);
+
+	for (size_t rules : { 10, 100, 1000 })
+		benchmarkRegexSet(rules);
+
+	for (int n : { 4, 8, 10, 16 })
+		benchmarkEngines(n);
+
+	for (size_t length : { 1 << 14, 1 << 16 }) {
+		benchmarkSearch("abc(a|b|c)*cba", "abc", length);
+		benchmarkSearch("a*b|a", "ab", length);
+		benchmarkSearch("(a|b)*a(a|b)(a|b)", "abcd", length);
+	}
+	// a run of a's: every offset starts a match, but the a* branch stays alive to the end
+	benchmarkSearch("a*b|a", "a", 1 << 15);
+	benchmarkSearch("abc(a|b|c)*cba", "abcdefgh", 8 << 20);
+
+	benchmarkPrefilter("error(0|1|2|3|4|5|6|7|8|9)*", 64 << 20);
+	benchmarkPrefilter("q(0|1|2|3|4|5|6|7|8|9)(a|b)*", 64 << 20);
+	benchmarkPrefilter("(q|x|z)(0|1|2|3|4|5|6|7|8|9)", 64 << 20);
+	benchmarkPrefilter("(a|b|c|d)(0|1|2|3|4|5|6|7|8|9)", 64 << 20);
+
+	benchmarkStaticRegex<"(a|b)*abb">("ab", 64);
+	benchmarkStaticRegex<"aba(aa|bb)*c(ab)*">("abc", 16);
+	benchmarkStaticRegex<"(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)">("ab", 64);
+
+	std::string letters = "abcdefghijklmnopqrstuvwxyz";
+	std::string digits = "0123456789";
+	benchmarkByteClasses("[a-z][a-z0-9]*", alternationOf(letters) + alternationOf(letters + digits) + "*", letters + digits + "_-", 16);
+	benchmarkByteClasses("[0-9]*(a|b)[^x]", alternationOf(digits) + "*(a|b)" + alternationOf(letters.substr(0, 23) + "yz" + digits), letters + digits, 8);
+
+	benchmarkInterleaved(8, 64);
+	benchmarkInterleaved(16, 64);
+	benchmarkInterleaved(18, 32);
+
+	benchmarkStream(8, 4096, 1);
+	benchmarkStream(8, 4096, 1500);
+
+	benchmarkParallel("(a|b)*abb", "ab", 256 << 20);
+	benchmarkParallel("((a|b)(a|b)(a|b)(a|b)(a|b))*", "ab", 256 << 20);
+	benchmarkParallel(suffixPattern(10), "ab", 256 << 20);
+
+	benchmarkParser("alternation/100000", keywordAlternation(100000, 8, 43));
+	benchmarkParser("nested/20000", nestedPattern(20000));
+	benchmarkParser("suffix/20000", suffixPattern(20000));
+
+	benchmarkCompiledDfa(4);
+	benchmarkCompiledDfa(5);
+
+	benchmarkGlushkov("suffix/12", suffixPattern(12), suffixWords(12, 20000, 64, 0.5, 53));
+	benchmarkGlushkov("nested/64", nestedPattern(64), nestedWords(64, 20000, 0.5, 59));
+	benchmarkGlushkov("alternation/2000", keywordAlternation(2000, 8, 61), keywordWords(2000, 8, 20000, 0.5, 61));
+
+	benchmarkNfaReduction("suffix/12", suffixPattern(12), suffixWords(12, 20000, 64, 0.5, 67));
+	benchmarkNfaReduction("nested/64", nestedPattern(64), nestedWords(64, 20000, 0.5, 71));
+	benchmarkNfaReduction("alternation/2000", keywordAlternation(2000, 8, 73), keywordWords(2000, 8, 20000, 0.5, 73));
+
+	CompileBudget states;
+	states.maxDfaStates = 1 << 14;
+	CompileBudget memory;
+	memory.maxBytes = 4 << 20;
+	CompileBudget time;
+	time.maxMs = 20;
+	benchmarkBudget(12, "none", CompileBudget());
+	for (int n : { 12, 22 }) {
+		benchmarkBudget(n, "16384 states", states);
+		benchmarkBudget(n, "4 MB", memory);
+		benchmarkBudget(n, "20 ms", time);
+	}
+
+	benchmarkRepetition("[ab]{1,1000}", repetitionWords("ab", 500, 2000, 0.5, 79));
+	benchmarkRepetition("(ab){1,1000}", repetitionWords("ab", 1000, 2000, 0.5, 83));
+	benchmarkRepetition(".{1,1000}x", repetitionWords("abx", 333, 2000, 0.5, 89));
+	benchmarkRepetition("[0-9]{3}-[0-9]{2,4}(-[0-9]+)?", repetitionWords("123-4567-89", 1, 20000, 0.5, 97));
+	return 0;
+}
@@ -0,0 +1,75 @@
+#include "BenchmarkReport.h"
+
+#include<iomanip>
+#include<iostream>
+
+#ifdef _WIN32
+#include<windows.h>
+#include<psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include<sys/resource.h>
+#endif
+
+size_t peakMemoryKb()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+bool BenchmarkReport::Open(const std::string& file_name)
+{
+	m_out.open(file_name);
+	if (!m_out.is_open())
+	{
+		std::cout << "Could not open " << file_name << " for writing.\n";
+		return false;
+	}
+	m_csv = file_name.size() >= 4 && file_name.compare(file_name.size() - 4, 4, ".csv") == 0;
+	if (m_csv)
+		m_out << "stage,corpus,param,iterations,ns,bytes,ns_per_byte,states,states_per_sec,accept_ratio,peak_kb\n";
+	return true;
+}
+
+void BenchmarkReport::Record(const BenchmarkRecord& record)
+{
+	double ns_per_byte = record.bytes ? record.ns / record.bytes : 0;
+	double states_per_sec = record.states && record.ns > 0 ? record.states * 1e9 / record.ns : 0;
+	size_t peak_kb = peakMemoryKb();
+
+	std::cout << std::left << std::setw(24) << record.stage << std::setw(12) << record.corpus << std::right << std::setw(7) << record.param
+		<< std::setw(14) << std::fixed << std::setprecision(0) << record.ns << " ns";
+	if (record.bytes)
+		std::cout << std::setw(10) << std::setprecision(3) << ns_per_byte << " ns/byte";
+	if (record.states)
+		std::cout << std::setw(10) << record.states << " states" << std::setw(14) << std::setprecision(0) << states_per_sec << " states/s";
+	if (record.stage == "CheckWord")
+		std::cout << "  accept " << std::setprecision(2) << record.acceptRatio;
+	std::cout << "  peak " << peak_kb << " KB\n" << std::defaultfloat;
+
+	if (!m_out.is_open())
+		return;
+	m_out << std::setprecision(6);
+	if (m_csv)
+		m_out << record.stage << ',' << record.corpus << ',' << record.param << ',' << record.iterations << ',' << record.ns << ','
+			<< record.bytes << ',' << ns_per_byte << ',' << record.states << ',' << states_per_sec << ',' << record.acceptRatio << ',' << peak_kb << '\n';
+	else
+		m_out << "{\"stage\":\"" << record.stage << "\",\"corpus\":\"" << record.corpus << "\",\"param\":" << record.param
+			<< ",\"iterations\":" << record.iterations << ",\"ns\":" << record.ns << ",\"bytes\":" << record.bytes
+			<< ",\"ns_per_byte\":" << ns_per_byte << ",\"states\":" << record.states << ",\"states_per_sec\":" << states_per_sec
+			<< ",\"accept_ratio\":" << record.acceptRatio << ",\"peak_kb\":" << peak_kb << "}\n";
+	m_out.flush();
+}
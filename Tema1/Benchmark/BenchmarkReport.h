@@ -0,0 +1,34 @@
+#pragma once
+
+#include<fstream>
+#include<string>
+
+// One measurement. Fields that do not apply to a stage are left at 0.
+struct BenchmarkRecord
+{
+	std::string stage;
+	std::string corpus;
+	long long param = 0;
+	size_t iterations = 0;
+	double ns = 0;
+	size_t bytes = 0;
+	size_t states = 0;
+	double acceptRatio = 0;
+};
+
+class BenchmarkReport
+{
+public:
+	BenchmarkReport() = default;
+	~BenchmarkReport() = default;
+
+	// a .csv path writes CSV, anything else JSON lines
+	bool Open(const std::string& file_name);
+	void Record(const BenchmarkRecord& record);
+
+private:
+	std::ofstream m_out;
+	bool m_csv = false;
+};
+
+size_t peakMemoryKb();
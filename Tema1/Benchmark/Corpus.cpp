@@ -0,0 +1,100 @@
+#include "Corpus.h"
+
+#include<random>
+
+std::vector<std::string> randomWords(const std::string& alphabet, size_t count, size_t length, unsigned seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+	std::vector<std::string> words(count);
+	for (auto& word : words)
+	{
+		word.resize(length);
+		for (char& symbol : word)
+			symbol = alphabet[pick(generator)];
+	}
+	return words;
+}
+
+std::string suffixPattern(int n)
+{
+	std::string regex = "(a|b)*a";
+	for (int i = 0; i < n; i++)
+		regex += "(a|b)";
+	return regex;
+}
+
+std::vector<std::string> suffixWords(int n, size_t count, size_t length, double accept_ratio, unsigned seed)
+{
+	std::vector<std::string> words = randomWords("ab", count, length, seed);
+	std::mt19937 generator(seed + 1);
+	std::bernoulli_distribution accept(accept_ratio);
+	// the word is accepted exactly when the (n+1)-th symbol from the end is an 'a'
+	if (length > (size_t)n)
+		for (auto& word : words)
+			word[length - n - 1] = accept(generator) ? 'a' : 'b';
+	return words;
+}
+
+std::string nestedPattern(int depth)
+{
+	std::string regex = "a";
+	for (int i = 1; i <= depth; i++)
+		regex = "(" + regex + ")*" + (char)('a' + i % 26);
+	return regex;
+}
+
+std::vector<std::string> nestedWords(int depth, size_t count, double accept_ratio, unsigned seed)
+{
+	// every star taken exactly once
+	std::string accepted = "a";
+	for (int i = 1; i <= depth; i++)
+		accepted += (char)('a' + i % 26);
+
+	std::mt19937 generator(seed);
+	std::bernoulli_distribution accept(accept_ratio);
+	std::uniform_int_distribution<int> position(1, depth);
+	std::vector<std::string> words(count, accepted);
+	for (auto& word : words)
+		if (!accept(generator))
+			word[position(generator)] = '#';
+	return words;
+}
+
+std::string keywordAlternation(size_t keywords, size_t length, unsigned seed)
+{
+	std::vector<std::string> words = randomWords("abcdefghijklmnopqrstuvwxyz", keywords, length, seed);
+	std::string regex = "(";
+	for (size_t i = 0; i < words.size(); i++)
+		regex += (i ? "|" : "") + words[i];
+	return regex + ")";
+}
+
+std::vector<std::string> keywordWords(size_t keywords, size_t length, size_t count, double accept_ratio, unsigned seed)
+{
+	std::vector<std::string> dictionary = randomWords("abcdefghijklmnopqrstuvwxyz", keywords, length, seed);
+	std::vector<std::string> words = randomWords("abcdefghijklmnopqrstuvwxyz", count, length, seed + 1);
+	std::mt19937 generator(seed + 2);
+	std::bernoulli_distribution accept(accept_ratio);
+	std::uniform_int_distribution<size_t> pick(0, keywords - 1);
+	for (auto& word : words)
+		if (accept(generator))
+			word = dictionary[pick(generator)];
+	return words;
+}
+
+std::vector<std::string> repetitionWords(const std::string& unit, int max_repeats, size_t count, double accept_ratio, unsigned seed)
+{
+	std::mt19937 generator(seed);
+	std::bernoulli_distribution accept(accept_ratio);
+	std::uniform_int_distribution<int> repeats(1, max_repeats + max_repeats / 4);
+	std::vector<std::string> words(count);
+	for (auto& word : words)
+	{
+		for (int i = repeats(generator); i > 0; i--)
+			word += unit;
+		if (!accept(generator))
+			word[std::uniform_int_distribution<size_t>(0, word.size() - 1)(generator)] = '#';
+	}
+	return words;
+}
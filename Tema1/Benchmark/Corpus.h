@@ -0,0 +1,25 @@
+#pragma once
+
+#include<string>
+#include<vector>
+
+std::vector<std::string> randomWords(const std::string& alphabet, size_t count, size_t length, unsigned seed);
+
+// (a|b)*a(a|b){n}: the smallest DFA has 2^(n+1) states
+std::string suffixPattern(int n);
+// words over {a, b} of which accept_ratio are accepted by suffixPattern(n)
+std::vector<std::string> suffixWords(int n, size_t count, size_t length, double accept_ratio, unsigned seed);
+
+// ((a)*b)*c...: depth nested groups, each closed by a star and followed by one more symbol
+std::string nestedPattern(int depth);
+// words of length depth + 1 of which accept_ratio are accepted by nestedPattern(depth)
+std::vector<std::string> nestedWords(int depth, size_t count, double accept_ratio, unsigned seed);
+
+// (w1|w2|...|wk) over random lowercase keywords
+std::string keywordAlternation(size_t keywords, size_t length, unsigned seed);
+// words of which accept_ratio are keywords of keywordAlternation(keywords, length, seed)
+std::vector<std::string> keywordWords(size_t keywords, size_t length, size_t count, double accept_ratio, unsigned seed);
+
+// unit repeated between 1 and max_repeats + max_repeats / 4 times, with one
+// byte replaced by '#' in 1 - accept_ratio of the words
+std::vector<std::string> repetitionWords(const std::string& unit, int max_repeats, size_t count, double accept_ratio, unsigned seed);
@@ -0,0 +1,110 @@
+#include "StageBenchmark.h"
+#include "Corpus.h"
+
+#include<chrono>
+#include<string>
+#include<vector>
+
+#include "../Tema1/DeterministicFiniteAutomaton.h"
+#include "../Tema1/NondeterministicFiniteAutomaton.h"
+#include "../Tema1/Regex.h"
+
+// runs stage until it has taken at least min_ms, returns ns per run
+template <typename Stage>
+double measure(size_t& iterations, Stage stage, double min_ms = 50)
+{
+	auto begin = std::chrono::steady_clock::now();
+	double elapsed = 0;
+	iterations = 0;
+	do {
+		stage();
+		iterations++;
+		elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+	} while (elapsed < min_ms * 1e6);
+	return elapsed / iterations;
+}
+
+// the front-end stages and the construction, each one fed the previous stage's output
+DeterministicFiniteAutomaton compileStages(BenchmarkReport& report, const std::string& corpus, long long param, const std::string& regex)
+{
+	BenchmarkRecord record;
+	record.corpus = corpus;
+	record.param = param;
+	record.bytes = regex.size();
+
+	std::string formatted;
+	record.stage = "formatRegex";
+	record.ns = measure(record.iterations, [&]() {
+		formatted = regex;
+		formatRegex(formatted);
+	});
+	report.Record(record);
+
+	std::vector<char> polishForm;
+	record.stage = "regexToPolishForm";
+	record.ns = measure(record.iterations, [&]() { polishForm = regexToPolishForm(formatted); });
+	report.Record(record);
+
+	NondeterministicFiniteAutomaton NFA;
+	record.stage = "returnAFNfromPolishForm";
+	record.ns = measure(record.iterations, [&]() { NFA = NFA.returnAFNfromPolishForm(polishForm); });
+	record.states = NFA.getStates().size();
+	report.Record(record);
+
+	DeterministicFiniteAutomaton DFA;
+	record.stage = "AFNtoAFD";
+	record.bytes = 0;
+	record.ns = measure(record.iterations, [&]() { DFA = DeterministicFiniteAutomaton().AFNtoAFD(NFA); });
+	record.states = DFA.getStates().size();
+	report.Record(record);
+	return DFA;
+}
+
+void matchStage(BenchmarkReport& report, DeterministicFiniteAutomaton& DFA, const std::string& corpus, long long param,
+	const std::vector<std::string>& words)
+{
+	DFA.getTransitionTable();
+	BenchmarkRecord record;
+	record.stage = "CheckWord";
+	record.corpus = corpus;
+	record.param = param;
+	for (const auto& word : words)
+		record.bytes += word.size();
+
+	size_t accepted = 0;
+	record.ns = measure(record.iterations, [&]() {
+		accepted = 0;
+		for (const auto& word : words)
+			accepted += DFA.CheckWord(word);
+	});
+	record.acceptRatio = words.empty() ? 0 : (double)accepted / words.size();
+	report.Record(record);
+}
+
+void benchmarkStages(BenchmarkReport& report)
+{
+	// 4 MB of input per CheckWord measurement
+	const size_t corpus_bytes = 4 << 20;
+
+	for (int n : { 4, 8, 12, 14 })
+	{
+		DeterministicFiniteAutomaton DFA = compileStages(report, "suffix", n, suffixPattern(n));
+		for (size_t length : { 16, 256, 4096 })
+			for (double ratio : { 0.0, 0.5, 1.0 })
+				matchStage(report, DFA, "suffix/" + std::to_string(length), n, suffixWords(n, corpus_bytes / length, length, ratio, 21));
+	}
+
+	for (int depth : { 16, 64, 256 })
+	{
+		DeterministicFiniteAutomaton DFA = compileStages(report, "nested", depth, nestedPattern(depth));
+		for (double ratio : { 0.0, 0.5, 1.0 })
+			matchStage(report, DFA, "nested", depth, nestedWords(depth, corpus_bytes / (depth + 1), ratio, 22));
+	}
+
+	for (size_t keywords : { 100, 1000, 10000 })
+	{
+		DeterministicFiniteAutomaton DFA = compileStages(report, "alternation", keywords, keywordAlternation(keywords, 8, 23));
+		for (double ratio : { 0.0, 0.5, 1.0 })
+			matchStage(report, DFA, "alternation", keywords, keywordWords(keywords, 8, corpus_bytes / 8, ratio, 23));
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "BenchmarkReport.h"
+
+// Times formatRegex, regexToPolishForm, returnAFNfromPolishForm, AFNtoAFD and
+// CheckWord separately on every synthetic corpus and records each of them.
+void benchmarkStages(BenchmarkReport& report);
@@ -0,0 +1,172 @@
+#include<algorithm>
+#include<chrono>
+#include<condition_variable>
+#include<cstring>
+#include<fstream>
+#include<mutex>
+#include<string_view>
+#include<thread>
+#include<vector>
+
+#include "BatchValidator.h"
+
+BatchValidator::BatchValidator(TransitionTableView table, unsigned threads, size_t chunk_size)
+	: m_table(table), m_threads(threads), m_chunk_size(chunk_size)
+{
+	if (m_threads == 0)
+		m_threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool BatchValidator::ValidateFile(const std::string& file_name, std::ostream* results, BatchResult& result)
+{
+	std::ifstream fin(file_name, std::ios::binary);
+	if (!fin)
+		return false;
+
+	auto begin = std::chrono::steady_clock::now();
+	result = BatchResult();
+
+	std::mutex mutex;
+	std::condition_variable wake, finished;
+	std::vector<const char*> bounds;
+	std::vector<BatchResult> partial(m_threads);
+	std::vector<std::string> verdicts(m_threads);
+	size_t generation = 0;
+	unsigned pending = 0;
+	bool stop = false;
+
+	auto worker = [&](unsigned index) {
+		size_t seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&]() { return stop || generation != seen; });
+				if (stop)
+					return;
+				seen = generation;
+			}
+			if (index + 1 < bounds.size())
+				ValidateSlice(bounds[index], bounds[index + 1], partial[index], results ? &verdicts[index] : nullptr);
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--pending == 0)
+				finished.notify_one();
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned i = 0; i < m_threads; i++)
+		pool.emplace_back(worker, i);
+
+	// waits for the chunk being matched, if any, and adds up its slices in order
+	auto collect = [&]() {
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [&]() { return pending == 0; });
+		for (unsigned i = 0; i < m_threads; i++) {
+			result.words += partial[i].words;
+			result.accepted += partial[i].accepted;
+			partial[i] = BatchResult();
+			if (results)
+				results->write(verdicts[i].data(), verdicts[i].size());
+			verdicts[i].clear();
+		}
+	};
+
+	std::vector<char> buffers[2] = { std::vector<char>(m_chunk_size), std::vector<char>(m_chunk_size) };
+	int current = 0;
+	size_t carry = 0;
+	bool last = false;
+	while (!last) {
+		std::vector<char>& buffer = buffers[current];
+		fin.read(buffer.data() + carry, buffer.size() - carry);
+		size_t filled = carry + (size_t)fin.gcount();
+		last = !fin;
+
+		size_t last_line = filled;
+		if (!last) {
+			while (last_line > 0 && buffer[last_line - 1] != '\n')
+				last_line--;
+			if (last_line == 0) {
+				// a single word longer than the buffer
+				carry = filled;
+				buffer.resize(buffer.size() * 2);
+				continue;
+			}
+		}
+
+		// the other buffer is free once its chunk is matched; the partial last line moves there
+		collect();
+		std::vector<char>& other = buffers[1 - current];
+		carry = filled - last_line;
+		if (other.size() < buffer.size())
+			other.resize(buffer.size());
+		std::memcpy(other.data(), buffer.data() + last_line, carry);
+
+		if (last_line > 0) {
+			std::lock_guard<std::mutex> lock(mutex);
+			bounds = Split(buffer.data(), buffer.data() + last_line);
+			pending = m_threads;
+			generation++;
+			wake.notify_all();
+		}
+		current = 1 - current;
+	}
+	collect();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	wake.notify_all();
+	for (auto& thread : pool)
+		thread.join();
+
+	auto end = std::chrono::steady_clock::now();
+	result.seconds = std::chrono::duration<double>(end - begin).count();
+	return true;
+}
+
+std::vector<const char*> BatchValidator::Split(const char* begin, const char* end) const
+{
+	std::vector<const char*> bounds = { begin };
+	size_t slice = (end - begin) / m_threads + 1;
+	for (unsigned i = 1; i < m_threads; i++) {
+		const char* cut = std::max(bounds.back(), begin + std::min((size_t)(end - begin), slice * i));
+		const char* newline = (const char*)std::memchr(cut, '\n', end - cut);
+		cut = newline ? newline + 1 : end;
+		if (cut > bounds.back() && cut < end)
+			bounds.push_back(cut);
+	}
+	bounds.push_back(end);
+	return bounds;
+}
+
+void BatchValidator::ValidateSlice(const char* begin, const char* end, BatchResult& counts, std::string* verdicts) const
+{
+	const char* position = begin;
+	std::vector<std::string_view> words;
+	std::vector<uint64_t> accepted;
+
+	while (position < end) {
+		// split off a batch of words, then match them interleaved
+		words.clear();
+		while (position < end && words.size() < kBatchWords) {
+			const char* newline = (const char*)std::memchr(position, '\n', end - position);
+			const char* word_end = newline ? newline : end;
+			size_t length = word_end - position;
+			if (length > 0 && position[length - 1] == '\r')
+				length--;
+			words.emplace_back(position, length);
+			position = newline ? newline + 1 : end;
+		}
+
+		m_table.CheckWords(words, accepted);
+		for (size_t i = 0; i < words.size(); i++) {
+			bool verdict = (accepted[i / 64] >> (i % 64)) & 1;
+			counts.accepted += verdict;
+			if (verdicts) {
+				*verdicts += verdict ? '1' : '0';
+				*verdicts += '\n';
+			}
+		}
+		counts.words += words.size();
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include<string>
+#include<ostream>
+#include<vector>
+
+#include "TransitionTable.h"
+
+struct BatchResult
+{
+	size_t words = 0;
+	size_t accepted = 0;
+	double seconds = 0;
+};
+
+// Validates a file of words, one per line, in chunks: a pool of m_threads
+// workers, kept for the whole file, matches the slices of one chunk while the
+// calling thread reads the next chunk into a second buffer, so reading and
+// matching overlap.
+class BatchValidator
+{
+public:
+	BatchValidator(TransitionTableView table, unsigned threads = 0, size_t chunk_size = 64 << 20);
+	~BatchValidator() = default;
+
+	bool ValidateFile(const std::string& file_name, std::ostream* results, BatchResult& result);
+
+private:
+	static constexpr size_t kBatchWords = 1024;
+
+	// cuts [begin, end) at line ends into up to m_threads slices
+	std::vector<const char*> Split(const char* begin, const char* end) const;
+	void ValidateSlice(const char* begin, const char* end, BatchResult& counts, std::string* verdicts) const;
+
+	TransitionTableView m_table;
+	unsigned m_threads;
+	size_t m_chunk_size;
+};
@@ -0,0 +1,292 @@
+#include<algorithm>
+#include<bitset>
+#include<cstdlib>
+#include<unordered_map>
+
+#include "BitParallelNfa.h"
+
+BitParallelNfa::BitParallelNfa(const NondeterministicFiniteAutomaton& AFN)
+	: BitParallelNfa(IndexedNfa(AFN))
+{
+}
+
+BitParallelNfa::BitParallelNfa(const IndexedNfa& indexed, BudgetMeter* budget)
+{
+	using ColumnSet = std::bitset<256>;
+	m_state_count = indexed.stateCount;
+	m_columns = indexed.columns;
+	size_t columns = indexed.columnCount;
+
+	// the symbol moves of each state, grouped by target: (target, columns)
+	std::vector<int> group_offset(m_state_count + 1, 0);
+	std::vector<std::pair<int, ColumnSet>> groups;
+	std::vector<int> group_of(m_state_count, -1);
+	for (int state = 0; state < m_state_count; state++) {
+		for (auto move = indexed.movesBegin(state); move != indexed.movesEnd(state); ++move) {
+			int& group = group_of[move->second];
+			if (group < group_offset[state]) {
+				group = (int)groups.size();
+				groups.push_back({ move->second, ColumnSet() });
+			}
+			groups[group].second.set(move->first);
+		}
+		group_offset[state + 1] = (int)groups.size();
+	}
+
+	// positions are numbered by target, so that a concatenation's positions follow each other
+	std::vector<std::vector<std::pair<ColumnSet, int>>> by_target(m_state_count);
+	for (const auto& [target, set] : groups) {
+		auto& entries = by_target[target];
+		if (std::none_of(entries.begin(), entries.end(), [&](const auto& entry) { return entry.first == set; }))
+			entries.push_back({ set, 0 });
+	}
+	std::vector<int> target_of = { indexed.initial };
+	std::vector<ColumnSet> columns_of = { ColumnSet() };
+	for (int state = 0; state < m_state_count; state++)
+		for (auto& entry : by_target[state]) {
+			entry.second = (int)target_of.size();
+			target_of.push_back(state);
+			columns_of.push_back(entry.first);
+		}
+	m_position_count = (int)target_of.size();
+	m_words = (m_position_count + 63) / 64;
+
+	// what is held from here on, before the follow sets: the position tables and the masks
+	size_t fixed_bytes = groups.size() * (sizeof(groups[0]) + sizeof(int)) + target_of.size() * (sizeof(int) + sizeof(ColumnSet))
+		+ (columns + kMaxShifts + 3) * m_words * sizeof(uint64_t);
+	if (budget && (!budget->Bytes(fixed_bytes) || !budget->Deadline())) {
+		Clear();
+		return;
+	}
+
+	std::vector<int> out(groups.size()); // position of each group
+	for (size_t i = 0; i < groups.size(); i++)
+		for (const auto& entry : by_target[groups[i].first])
+			if (entry.first == groups[i].second)
+				out[i] = entry.second;
+
+	m_entered.assign(columns * m_words, 0);
+	for (int position = 1; position < m_position_count; position++)
+		for (size_t column = 0; column < columns; column++)
+			if (columns_of[position][column])
+				m_entered[column * m_words + position / 64] |= 1ull << (position % 64);
+
+	m_accepting.assign(m_words, 0);
+	std::vector<int> follow_offset = { 0 };
+	std::vector<int> follows;
+	std::vector<int> seen(m_position_count, -1);
+	std::vector<size_t> distance_count(2 * kMaxDistance + 1, 0);
+	for (int position = 0; position < m_position_count; position++) {
+		size_t begin = follows.size();
+		for (auto it = indexed.closureBegin(target_of[position]); it != indexed.closureEnd(target_of[position]); ++it) {
+			if (indexed.accepting[*it])
+				m_accepting[position / 64] |= 1ull << (position % 64);
+			for (int group = group_offset[*it]; group < group_offset[*it + 1]; group++)
+				if (seen[out[group]] != position) {
+					seen[out[group]] = position;
+					follows.push_back(out[group]);
+				}
+		}
+		std::sort(follows.begin() + begin, follows.end());
+		follow_offset.push_back((int)follows.size());
+		if (budget && (!budget->Bytes(fixed_bytes + (follows.size() + follow_offset.size()) * sizeof(int)) || !budget->Tick())) {
+			Clear();
+			return;
+		}
+		for (size_t i = begin; i < follows.size(); i++)
+			if (std::abs(follows[i] - position) <= kMaxDistance)
+				distance_count[follows[i] - position + kMaxDistance]++;
+	}
+
+	// a shift costs a pass over the words every step, so it has to replace at least as many follow pairs
+	std::vector<int> distances;
+	for (int distance = -kMaxDistance; distance <= kMaxDistance; distance++)
+		if (distance_count[distance + kMaxDistance] >= std::max<size_t>(m_words, 2))
+			distances.push_back(distance);
+	std::sort(distances.begin(), distances.end(), [&](int a, int b) {
+		return distance_count[a + kMaxDistance] > distance_count[b + kMaxDistance];
+	});
+	if (distances.size() > kMaxShifts)
+		distances.resize(kMaxShifts);
+	std::vector<int> shift_of(2 * kMaxDistance + 1, -1);
+	m_shifts.clear();
+	for (int distance : distances) {
+		shift_of[distance + kMaxDistance] = (int)m_shifts.size();
+		m_shifts.push_back(distance);
+	}
+	m_shift_masks.assign(m_shifts.size() * m_words, 0);
+
+	m_irregular.assign(m_words, 0);
+	m_follow.assign(m_position_count, -1);
+	m_sets.clear();
+	m_dense.clear();
+	m_sparse.clear();
+
+	std::unordered_map<std::vector<int>, int, SubsetHash> set_ids;
+	std::vector<int> follow;
+	for (int position = 0; position < m_position_count; position++) {
+		uint64_t bit = 1ull << (position % 64);
+		follow.clear();
+		for (int i = follow_offset[position]; i < follow_offset[position + 1]; i++) {
+			int distance = follows[i] - position;
+			int shift = std::abs(distance) <= kMaxDistance ? shift_of[distance + kMaxDistance] : -1;
+			if (shift == -1)
+				follow.push_back(follows[i]);
+			else
+				m_shift_masks[shift * m_words + position / 64] |= bit;
+		}
+		if (follow.empty())
+			continue;
+
+		auto [it, added] = set_ids.try_emplace(follow, (int)m_sets.size());
+		if (added) {
+			// a mask is smaller once the set has more positions than the mask has words
+			FollowSet set = { 0, (int)follow.size(), follow.size() >= m_words };
+			if (set.dense) {
+				set.offset = m_dense.size();
+				m_dense.resize(m_dense.size() + m_words, 0);
+				for (int target : follow)
+					m_dense[set.offset + target / 64] |= 1ull << (target % 64);
+			}
+			else {
+				set.offset = m_sparse.size();
+				m_sparse.insert(m_sparse.end(), follow.begin(), follow.end());
+			}
+			m_sets.push_back(set);
+		}
+		m_follow[position] = it->second;
+		m_irregular[position / 64] |= bit;
+	}
+}
+
+void BitParallelNfa::Clear()
+{
+	m_position_count = 0;
+	m_words = 0;
+	m_accepting.clear();
+	m_entered.clear();
+	m_shifts.clear();
+	m_shift_masks.clear();
+	m_irregular.clear();
+	m_follow.clear();
+	m_sets.clear();
+	m_dense.clear();
+	m_sparse.clear();
+}
+
+void BitParallelNfa::ApplyFollow(const FollowSet& set, uint64_t* next) const
+{
+	if (set.dense) {
+		const uint64_t* mask = m_dense.data() + set.offset;
+		for (size_t w = 0; w < m_words; w++)
+			next[w] |= mask[w];
+	}
+	else
+		for (const int* it = m_sparse.data() + set.offset, *end = it + set.size; it != end; ++it)
+			next[*it / 64] |= 1ull << (*it % 64);
+}
+
+void BitParallelNfa::Shift(const uint64_t* current, const uint64_t* mask, int distance, uint64_t* next) const
+{
+	if (distance > 0) {
+		uint64_t carry = 0;
+		for (size_t w = 0; w < m_words; w++) {
+			uint64_t moving = current[w] & mask[w];
+			next[w] |= (moving << distance) | carry;
+			carry = moving >> (64 - distance);
+		}
+	}
+	else if (distance < 0) {
+		uint64_t carry = 0;
+		for (size_t w = m_words; w-- > 0;) {
+			uint64_t moving = current[w] & mask[w];
+			next[w] |= (moving >> -distance) | carry;
+			carry = moving << (64 + distance);
+		}
+	}
+	else
+		for (size_t w = 0; w < m_words; w++)
+			next[w] |= current[w] & mask[w];
+}
+
+bool BitParallelNfa::CheckWord(const std::string& word, Scratch& scratch) const
+{
+	return CheckWord(word.data(), word.size(), scratch);
+}
+
+bool BitParallelNfa::CheckWord(const char* word, size_t length, Scratch& scratch) const
+{
+	if (m_position_count == 0)
+		return false;
+
+	scratch.current.assign(m_words, 0);
+	scratch.next.resize(m_words);
+	if (scratch.applied.size() < m_sets.size())
+		scratch.applied.resize(m_sets.size(), scratch.step);
+	uint64_t* current = scratch.current.data();
+	uint64_t* next = scratch.next.data();
+	uint32_t* applied = scratch.applied.data();
+	current[0] = 1;
+
+	bool accepted = true;
+	for (size_t i = 0; i < length; i++) {
+		int column = m_columns[(unsigned char)word[i]];
+		if (column < 0) {
+			accepted = false;
+			break;
+		}
+
+		std::fill(next, next + m_words, 0);
+		for (size_t shift = 0; shift < m_shifts.size(); shift++)
+			Shift(current, m_shift_masks.data() + shift * m_words, m_shifts[shift], next);
+
+		// positions sharing a follow set apply it once
+		if (++scratch.step == 0) {
+			std::fill(scratch.applied.begin(), scratch.applied.end(), 0);
+			scratch.step = 1;
+		}
+		for (size_t w = 0; w < m_words; w++)
+			for (uint64_t irregular = current[w] & m_irregular[w]; irregular; irregular &= irregular - 1) {
+				int set = m_follow[w * 64 + std::countr_zero(irregular)];
+				if (applied[set] == scratch.step)
+					continue;
+				applied[set] = scratch.step;
+				ApplyFollow(m_sets[set], next);
+			}
+
+		const uint64_t* entered = m_entered.data() + (size_t)column * m_words;
+		uint64_t alive = 0;
+		for (size_t w = 0; w < m_words; w++) {
+			next[w] &= entered[w];
+			alive |= next[w];
+		}
+		if (!alive) {
+			accepted = false;
+			break;
+		}
+		std::swap(current, next);
+	}
+
+	if (accepted) {
+		accepted = false;
+		for (size_t w = 0; w < m_words; w++)
+			accepted |= (current[w] & m_accepting[w]) != 0;
+	}
+	return accepted;
+}
+
+size_t BitParallelNfa::getStateCount() const
+{
+	return m_state_count;
+}
+
+size_t BitParallelNfa::getPositionCount() const
+{
+	return m_position_count;
+}
+
+size_t BitParallelNfa::getMemoryBytes() const
+{
+	return (m_accepting.size() + m_entered.size() + m_shift_masks.size() + m_irregular.size() + m_dense.size()) * sizeof(uint64_t)
+		+ (m_follow.size() + m_sparse.size()) * sizeof(int) + m_sets.size() * sizeof(FollowSet);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include<bit>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+#include "IndexedNfa.h"
+
+// Simulates an NFA (Thompson or Glushkov) directly, as the position automaton
+// of its symbol moves: position 0 is the start, and every other position
+// stands for one target state entered on one set of columns. The active
+// positions are a bitset, and a step on a column is
+//   next = (OR over shifts d of (active & shift_d) << d | follow sets of the irregular active positions) & entered[column]
+// Positions are numbered along the NFA, so most follow pairs are a handful of
+// distances apart (1 along a concatenation, 2 and 3 across (a|b)...); those
+// become word-wide shifts. The remaining follow sets are deduplicated and each
+// is applied once per step, so memory grows with the positions and their
+// follow sets rather than with positions squared. No subset construction is ever performed.
+class BitParallelNfa
+{
+public:
+	// Buffers for CheckWord, owned by the caller so that matching never
+	// allocates once they have grown to size; one per thread.
+	struct Scratch
+	{
+		std::vector<uint64_t> current;
+		std::vector<uint64_t> next;
+		std::vector<uint32_t> applied; // per follow set, the step it was last applied in
+		uint32_t step = 0;
+	};
+
+	explicit BitParallelNfa(const NondeterministicFiniteAutomaton& AFN);
+	// with a budget, gives up as soon as the tables would exceed its memory or
+	// time limit, leaving a simulation that rejects every word
+	explicit BitParallelNfa(const IndexedNfa& indexed, BudgetMeter* budget = nullptr);
+	~BitParallelNfa() = default;
+
+	bool CheckWord(const std::string& word, Scratch& scratch) const;
+	bool CheckWord(const char* word, size_t length, Scratch& scratch) const;
+
+	size_t getStateCount() const; // of the NFA
+	size_t getPositionCount() const;
+	size_t getMemoryBytes() const;
+
+private:
+	struct FollowSet
+	{
+		size_t offset; // in m_dense (words) or m_sparse (positions)
+		int size;
+		bool dense;
+	};
+
+	static constexpr int kMaxDistance = 63; // a shift moves bits by at most one word
+	static constexpr size_t kMaxShifts = 8;
+
+	void Shift(const uint64_t* current, const uint64_t* mask, int distance, uint64_t* next) const;
+	void ApplyFollow(const FollowSet& set, uint64_t* next) const;
+	void Clear();
+
+	int m_state_count;
+	int m_position_count;
+	size_t m_words; // 64-bit words per position set
+	std::array<int, 256> m_columns;
+	std::vector<uint64_t> m_accepting;
+	std::vector<uint64_t> m_entered; // per column: positions entered on it
+	std::vector<int> m_shifts; // distances from a position to one it is followed by
+	std::vector<uint64_t> m_shift_masks; // per shift: positions followed at that distance
+	std::vector<uint64_t> m_irregular; // positions with a follow set
+	std::vector<int> m_follow; // per position, index in m_sets or -1
+	std::vector<FollowSet> m_sets; // deduplicated, without the shifted pairs
+	std::vector<uint64_t> m_dense;
+	std::vector<int> m_sparse;
+};
@@ -0,0 +1,101 @@
+#include "CompileBudget.h"
+
+bool CompileBudget::isUnlimited() const
+{
+	return maxNfaStates == 0 && maxDfaStates == 0 && maxBytes == 0 && maxMs <= 0;
+}
+
+std::string BudgetError::describe() const
+{
+	switch (limit)
+	{
+	case BudgetLimit::NfaStates:
+		return "NFA has more than " + std::to_string(allowed) + " states (" + std::to_string(reached) + ")";
+	case BudgetLimit::DfaStates:
+		return "DFA has more than " + std::to_string(allowed) + " states (" + std::to_string(reached) + ")";
+	case BudgetLimit::Memory:
+		return "compilation holds more than " + std::to_string(allowed) + " bytes (" + std::to_string(reached) + ")";
+	case BudgetLimit::Time:
+		return "compilation took longer than " + std::to_string(allowed) + " ms (" + std::to_string(reached) + ")";
+	default:
+		return "within budget";
+	}
+}
+
+BudgetMeter::BudgetMeter(const CompileBudget& budget)
+	: m_budget(budget)
+{
+	Start();
+}
+
+void BudgetMeter::Start()
+{
+	m_start = std::chrono::steady_clock::now();
+	m_ticks = 0;
+	m_error = BudgetError();
+}
+
+bool BudgetMeter::Exceed(BudgetLimit limit, size_t allowed, size_t reached)
+{
+	if (m_error.limit == BudgetLimit::None)
+		m_error = { limit, allowed, reached };
+	return false;
+}
+
+bool BudgetMeter::NfaStates(size_t states)
+{
+	if (isExceeded())
+		return false;
+	if (m_budget.maxNfaStates != 0 && states > m_budget.maxNfaStates)
+		return Exceed(BudgetLimit::NfaStates, m_budget.maxNfaStates, states);
+	return true;
+}
+
+bool BudgetMeter::DfaStates(size_t states, size_t bytes)
+{
+	if (isExceeded())
+		return false;
+	if (m_budget.maxDfaStates != 0 && states > m_budget.maxDfaStates)
+		return Exceed(BudgetLimit::DfaStates, m_budget.maxDfaStates, states);
+	return Bytes(bytes);
+}
+
+bool BudgetMeter::Bytes(size_t bytes)
+{
+	if (isExceeded())
+		return false;
+	if (m_budget.maxBytes != 0 && bytes > m_budget.maxBytes)
+		return Exceed(BudgetLimit::Memory, m_budget.maxBytes, bytes);
+	return true;
+}
+
+bool BudgetMeter::Deadline()
+{
+	if (isExceeded())
+		return false;
+	if (m_budget.maxMs <= 0)
+		return true;
+
+	double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+	if (elapsed > m_budget.maxMs)
+		return Exceed(BudgetLimit::Time, (size_t)m_budget.maxMs, (size_t)elapsed);
+	return true;
+}
+
+bool BudgetMeter::Tick()
+{
+	if (++m_ticks < kClockInterval)
+		return !isExceeded();
+	m_ticks = 0;
+	return Deadline();
+}
+
+bool BudgetMeter::isExceeded() const
+{
+	return m_error.limit != BudgetLimit::None;
+}
+
+const BudgetError& BudgetMeter::getError() const
+{
+	return m_error;
+}
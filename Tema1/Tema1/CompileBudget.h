@@ -0,0 +1,71 @@
+#pragma once
+
+#include<chrono>
+#include<cstddef>
+#include<string>
+
+enum class BudgetLimit
+{
+	None,
+	NfaStates,
+	DfaStates,
+	Memory,
+	Time
+};
+
+// Limits on one compilation, 0 meaning unlimited. Memory counts what the
+// subset construction holds: the subset keys of state_mapping and one row of
+// transitions per DFA state; or, for an NFA simulation, its indexed NFA and tables.
+struct CompileBudget
+{
+	size_t maxNfaStates = 0;
+	size_t maxDfaStates = 0;
+	size_t maxBytes = 0;
+	double maxMs = 0; // wall clock, from the start of the compilation
+	bool fallback = false; // Matcher: simulate the NFA instead of failing when a Dfa is over budget
+
+	bool isUnlimited() const;
+};
+
+// The first limit a compilation ran into; limit is None while it is within budget.
+struct BudgetError
+{
+	BudgetLimit limit = BudgetLimit::None;
+	size_t allowed = 0; // states, bytes or milliseconds
+	size_t reached = 0;
+
+	std::string describe() const;
+};
+
+// Charges one compilation against a CompileBudget. The clock starts with
+// Start; Tick only reads it every kClockInterval calls, so an inner loop can
+// check the deadline cheaply.
+class BudgetMeter
+{
+public:
+	BudgetMeter() = default;
+	explicit BudgetMeter(const CompileBudget& budget);
+	~BudgetMeter() = default;
+
+	void Start();
+
+	// false once a limit is exceeded, and from then on
+	bool NfaStates(size_t states);
+	bool DfaStates(size_t states, size_t bytes);
+	bool Bytes(size_t bytes);
+	bool Deadline();
+	bool Tick();
+
+	bool isExceeded() const;
+	const BudgetError& getError() const;
+
+private:
+	static constexpr unsigned kClockInterval = 64;
+
+	bool Exceed(BudgetLimit limit, size_t allowed, size_t reached);
+
+	CompileBudget m_budget;
+	std::chrono::steady_clock::time_point m_start;
+	unsigned m_ticks = 0;
+	BudgetError m_error;
+};
@@ -0,0 +1,59 @@
+#include "CompiledDfa.h"
+
+std::optional<CompiledDfa> CompiledDfa::Freeze(DeterministicFiniteAutomaton& DFA)
+{
+	return Freeze(DFA.getTransitionTable());
+}
+
+std::optional<CompiledDfa> CompiledDfa::Freeze(const TransitionTable& table)
+{
+	if (!isConsistent(table))
+		return std::nullopt;
+
+	CompiledDfa compiled;
+	compiled.m_table = table;
+	return compiled;
+}
+
+bool CompiledDfa::isConsistent(const TransitionTable& table)
+{
+	// what CheckWord relies on, so it never has to check anything per byte
+	if (table.dead <= 0 || table.columnCount <= 0)
+		return false;
+	size_t rows = (size_t)table.dead + 1;
+	if (table.next.size() != rows * table.columnCount || table.accepting.size() != rows)
+		return false;
+	if (table.start < 0 || table.start >= table.dead || table.accepting[table.dead])
+		return false;
+
+	for (int column : table.columns)
+		if (column < 0 || column >= table.columnCount)
+			return false;
+	for (int target : table.next)
+		if (target < 0 || target > table.dead)
+			return false;
+	for (int column = 0; column < table.columnCount; column++)
+		if (table.next[(size_t)table.dead * table.columnCount + column] != table.dead)
+			return false;
+	return true;
+}
+
+bool CompiledDfa::CheckWord(std::string_view word) const
+{
+	return m_table.view().CheckWord(word.data(), word.size());
+}
+
+void CompiledDfa::CheckWords(std::span<const std::string_view> words, std::vector<uint64_t>& accepted) const
+{
+	m_table.view().CheckWords(words, accepted);
+}
+
+size_t CompiledDfa::getStateCount() const
+{
+	return m_table.dead;
+}
+
+TransitionTableView CompiledDfa::view() const
+{
+	return m_table.view();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include<cstdint>
+#include<optional>
+#include<span>
+#include<string_view>
+#include<vector>
+
+#include "DeterministicFiniteAutomaton.h"
+#include "TransitionTable.h"
+
+// A DFA frozen for matching. Its dense table is copied and checked once, when
+// it is frozen, and never changes afterwards: every method is const, does no
+// I/O and only reads, so one CompiledDfa can be shared by any number of
+// threads without locking, and a query costs O(word length).
+class CompiledDfa
+{
+public:
+	// nothing when the table is unusable: no states, or an entry pointing outside it
+	static std::optional<CompiledDfa> Freeze(DeterministicFiniteAutomaton& DFA);
+	static std::optional<CompiledDfa> Freeze(const TransitionTable& table);
+
+	bool CheckWord(std::string_view word) const;
+	void CheckWords(std::span<const std::string_view> words, std::vector<uint64_t>& accepted) const;
+
+	size_t getStateCount() const; // without the dead state
+	TransitionTableView view() const;
+
+private:
+	CompiledDfa() = default;
+
+	static bool isConsistent(const TransitionTable& table);
+
+	TransitionTable m_table;
+};
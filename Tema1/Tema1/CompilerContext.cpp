@@ -0,0 +1,108 @@
+#include<algorithm>
+#include<atomic>
+#include<thread>
+
+#include "CompilerContext.h"
+
+int CompilerContext::NewState()
+{
+	return m_stateCounter++;
+}
+
+void CompilerContext::Reset()
+{
+	m_stateCounter = 0;
+	m_builder.Clear();
+}
+
+bool CompilerContext::CompileNfa(const std::string& regex, NfaGraph& graph)
+{
+	Reset();
+	m_reduction = NfaReduction();
+	m_meter = BudgetMeter(m_budget);
+	if (!m_parser.Parse(regex, m_ast) || !m_meter.Deadline())
+		return false;
+	// every position a repetition copies out is at least one state: refuse before copying
+	if (!m_ast.repeats.empty() && !m_meter.NfaStates(m_ast.ExpandedSize(RegexParser::kMaxExpandedSize)))
+		return false;
+	bool built = m_construction == NfaConstruction::Glushkov ? m_glushkov.Build(m_ast, graph) : m_builder.BuildFromAst(m_ast, graph);
+	if (!built || !m_meter.NfaStates(graph.stateCount) || !m_meter.Deadline())
+		return false;
+	if (m_reduce)
+		m_reduction = m_reducer.Reduce(graph);
+	return m_meter.Deadline();
+}
+
+void CompilerContext::setConstruction(NfaConstruction construction)
+{
+	m_construction = construction;
+}
+
+void CompilerContext::setReduceNfa(bool reduce)
+{
+	m_reduce = reduce;
+}
+
+const NfaReduction& CompilerContext::getReduction() const
+{
+	return m_reduction;
+}
+
+void CompilerContext::setBudget(const CompileBudget& budget)
+{
+	m_budget = budget;
+}
+
+const RegexParser& CompilerContext::getParser() const
+{
+	return m_parser;
+}
+
+const BudgetError& CompilerContext::getBudgetError() const
+{
+	return m_meter.getError();
+}
+
+BudgetMeter& CompilerContext::getMeter()
+{
+	return m_meter;
+}
+
+bool CompilerContext::CompileDfa(const std::string& regex, DeterministicFiniteAutomaton& dfa, bool minimize)
+{
+	NfaGraph graph;
+	if (!CompileNfa(regex, graph))
+		return false;
+
+	dfa = DeterministicFiniteAutomaton().AFNtoAFD(IndexedNfa(graph), minimize, &m_meter);
+	return !m_meter.isExceeded();
+}
+
+std::vector<std::optional<DeterministicFiniteAutomaton>> CompilerContext::CompileAll(const std::vector<std::string>& regexes, unsigned threads,
+	const CompileBudget& budget)
+{
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = (unsigned)std::min<size_t>(threads, std::max<size_t>(regexes.size(), 1));
+
+	std::vector<std::optional<DeterministicFiniteAutomaton>> result(regexes.size());
+	std::atomic<size_t> next = 0;
+
+	auto worker = [&]() {
+		CompilerContext context;
+		context.setBudget(budget);
+		DeterministicFiniteAutomaton dfa;
+		for (size_t i = next++; i < regexes.size(); i = next++)
+			if (context.CompileDfa(regexes[i], dfa))
+				result[i] = std::move(dfa);
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned i = 1; i < threads; i++)
+		pool.emplace_back(worker);
+	worker();
+	for (auto& thread : pool)
+		thread.join();
+
+	return result;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include<optional>
+#include<string>
+#include<vector>
+
+#include "CompileBudget.h"
+#include "DeterministicFiniteAutomaton.h"
+#include "GlushkovBuilder.h"
+#include "NfaBuilder.h"
+#include "NfaReducer.h"
+#include "RegexParser.h"
+
+enum class NfaConstruction
+{
+	Thompson, // NfaBuilder: lambda edges around every operator
+	Glushkov // GlushkovBuilder: one state per symbol occurrence, no lambda edges
+};
+
+// Owns the state numbering and scratch buffers of one compilation at a time.
+// Contexts share nothing, so separate threads can compile with separate
+// contexts; every automaton is numbered from state 0.
+class CompilerContext
+{
+public:
+	CompilerContext() = default;
+	~CompilerContext() = default;
+
+	int NewState();
+	void Reset();
+	void setConstruction(NfaConstruction construction);
+	void setReduceNfa(bool reduce); // run NfaReducer on every NFA before it is returned
+	const NfaReduction& getReduction() const;
+	void setBudget(const CompileBudget& budget); // enforced from the start of every CompileNfa / CompileDfa
+
+	bool CompileNfa(const std::string& regex, NfaGraph& graph);
+	bool CompileDfa(const std::string& regex, DeterministicFiniteAutomaton& dfa, bool minimize = true);
+
+	// why the last compilation failed: the regex was rejected, or else it went over budget
+	const RegexParser& getParser() const;
+	const BudgetError& getBudgetError() const;
+	BudgetMeter& getMeter(); // the last compilation's, still running, for whatever is built from its NFA
+
+	static std::vector<std::optional<DeterministicFiniteAutomaton>> CompileAll(const std::vector<std::string>& regexes, unsigned threads = 0,
+		const CompileBudget& budget = CompileBudget());
+
+private:
+	int m_stateCounter = 0;
+	NfaConstruction m_construction = NfaConstruction::Thompson;
+	NfaBuilder m_builder;
+	GlushkovBuilder m_glushkov;
+	bool m_reduce = false;
+	NfaReducer m_reducer;
+	NfaReduction m_reduction;
+	CompileBudget m_budget;
+	BudgetMeter m_meter;
+	RegexParser m_parser;
+	RegexAst m_ast;
+};
@@ -0,0 +1,184 @@
+#include<algorithm>
+#include<bit>
+
+#include "CountingNfa.h"
+
+bool CountingNfa::Compile(const std::string& regex, BudgetMeter* budget)
+{
+	m_position_count = 0;
+	RegexAst ast;
+	if (!m_parser.Parse(regex, ast))
+		return false;
+	if (budget && (!budget->NfaStates(ast.ExpandedSize(RegexParser::kMaxExpandedSize, true) + 1) || !budget->Deadline()))
+		return false;
+
+	NfaGraph graph;
+	std::vector<CountedPosition> counted;
+	GlushkovBuilder().Build(ast, graph, &counted);
+
+	m_position_count = graph.stateCount;
+	m_words = (m_position_count + 63) / 64;
+	m_follow_offset = graph.edgeOffset;
+	m_follow.clear();
+	m_bytes.assign(m_position_count, ByteSet());
+	for (const NfaEdge& edge : graph.edges) {
+		m_follow.push_back(edge.to);
+		if (edge.symbol < NfaGraph::kClass)
+			m_bytes[edge.to].set(edge.symbol);
+		else
+			m_bytes[edge.to] = graph.classes[edge.symbol - NfaGraph::kClass];
+	}
+
+	m_accepting.assign(m_words, 0);
+	for (int position = 0; position < m_position_count; position++)
+		if (graph.accepting[position])
+			m_accepting[position / 64] |= 1ull << (position % 64);
+
+	m_counters.clear();
+	m_counter_of.assign(m_position_count, -1);
+	m_count_words = 0;
+	for (const CountedPosition& position : counted) {
+		Counter counter;
+		counter.position = position.position;
+		counter.saturating = position.max == RegexRepeat::kUnbounded;
+		counter.width = counter.saturating ? position.min : position.max;
+		counter.exit = std::max(position.min, 1) - 1;
+		counter.offset = m_count_words;
+		counter.words = (counter.width + 63) / 64;
+		m_count_words += counter.words;
+		m_counter_of[position.position] = (int)m_counters.size();
+		m_counters.push_back(counter);
+	}
+
+	if (budget && (!budget->Bytes(getMemoryBytes()) || !budget->Deadline())) {
+		m_position_count = 0;
+		return false;
+	}
+	return true;
+}
+
+bool CountingNfa::CanLeave(int position, const uint64_t* counts) const
+{
+	int index = m_counter_of[position];
+	if (index == -1)
+		return true;
+
+	const Counter& counter = m_counters[index];
+	const uint64_t* bits = counts + counter.offset;
+	size_t word = counter.exit / 64;
+	if (bits[word] >> (counter.exit % 64))
+		return true;
+	for (word++; word < counter.words; word++)
+		if (bits[word])
+			return true;
+	return false;
+}
+
+bool CountingNfa::CheckWord(const std::string& word, Scratch& scratch) const
+{
+	return CheckWord(word.data(), word.size(), scratch);
+}
+
+bool CountingNfa::CheckWord(const char* word, size_t length, Scratch& scratch) const
+{
+	if (m_position_count == 0)
+		return false;
+
+	scratch.current.assign(m_words, 0);
+	scratch.next.resize(m_words);
+	scratch.counts.assign(m_count_words, 0);
+	scratch.nextCounts.resize(m_count_words);
+	std::vector<uint64_t>& current = scratch.current;
+	std::vector<uint64_t>& next = scratch.next;
+	std::vector<uint64_t>& counts = scratch.counts;
+	std::vector<uint64_t>& next_counts = scratch.nextCounts;
+	current[0] = 1;
+
+	for (size_t i = 0; i < length; i++) {
+		unsigned char symbol = word[i];
+		std::fill(next.begin(), next.end(), 0);
+
+		for (size_t w = 0; w < m_words; w++)
+			for (uint64_t active = current[w]; active; active &= active - 1) {
+				int position = (int)(w * 64) + std::countr_zero(active);
+				if (!CanLeave(position, counts.data()))
+					continue;
+				for (int k = m_follow_offset[position]; k < m_follow_offset[position + 1]; k++) {
+					int target = m_follow[k];
+					if (m_bytes[target][symbol])
+						next[target / 64] |= 1ull << (target % 64);
+				}
+			}
+
+		// a counted position entered from outside starts at 1, one that stays on its bytes counts up
+		for (const Counter& counter : m_counters) {
+			int position = counter.position;
+			uint64_t bit = 1ull << (position % 64);
+			const uint64_t* from = counts.data() + counter.offset;
+			uint64_t* to = next_counts.data() + counter.offset;
+			bool stays = (current[position / 64] & bit) && m_bytes[position][symbol];
+
+			bool any = false;
+			if (stays) {
+				uint64_t carry = 0;
+				for (size_t w = 0; w < counter.words; w++) {
+					to[w] = (from[w] << 1) | carry;
+					carry = from[w] >> 63;
+				}
+				size_t top = counter.width - 1;
+				if (counter.saturating && (from[top / 64] >> (top % 64) & 1))
+					to[top / 64] |= 1ull << (top % 64);
+				if (counter.width % 64)
+					to[counter.words - 1] &= (1ull << (counter.width % 64)) - 1;
+				for (size_t w = 0; w < counter.words && !any; w++)
+					any = to[w] != 0;
+			}
+			else
+				std::fill(to, to + counter.words, 0);
+			if (next[position / 64] & bit) {
+				to[0] |= 1;
+				any = true;
+			}
+			if (any)
+				next[position / 64] |= bit;
+		}
+
+		bool alive = false;
+		for (size_t w = 0; w < m_words && !alive; w++)
+			alive = next[w] != 0;
+		if (!alive)
+			return false;
+		current.swap(next);
+		counts.swap(next_counts);
+	}
+
+	for (size_t w = 0; w < m_words; w++)
+		for (uint64_t accepted = current[w] & m_accepting[w]; accepted; accepted &= accepted - 1)
+			if (CanLeave((int)(w * 64) + std::countr_zero(accepted), counts.data()))
+				return true;
+	return false;
+}
+
+size_t CountingNfa::getPositionCount() const
+{
+	return m_position_count;
+}
+
+size_t CountingNfa::getCounterBits() const
+{
+	size_t bits = 0;
+	for (const Counter& counter : m_counters)
+		bits += counter.width;
+	return bits;
+}
+
+size_t CountingNfa::getMemoryBytes() const
+{
+	return m_bytes.size() * sizeof(ByteSet) + (m_follow_offset.size() + m_follow.size() + m_counter_of.size()) * sizeof(int)
+		+ m_accepting.size() * sizeof(uint64_t) + m_counters.size() * sizeof(Counter);
+}
+
+const RegexParser& CountingNfa::getParser() const
+{
+	return m_parser;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include<cstdint>
+#include<string>
+#include<vector>
+
+#include "CompileBudget.h"
+#include "GlushkovBuilder.h"
+#include "RegexParser.h"
+
+// Simulates the Glushkov automaton of a regex in which every repetition of a
+// single-byte operand, such as [0-9]{2,4} or (a|b){1,1000}, is one counted
+// position: next to the active positions, each counter keeps the set of counts
+// its position can be at, as a bitset shifted by one on every byte. A count of
+// n costs n bits and a shift per byte, instead of n positions and their follow
+// edges; other repetitions are copied out as usual.
+class CountingNfa
+{
+public:
+	// Buffers for CheckWord, owned by the caller so that matching never
+	// allocates once they have grown to size; one per thread.
+	struct Scratch
+	{
+		std::vector<uint64_t> current;
+		std::vector<uint64_t> next;
+		std::vector<uint64_t> counts;
+		std::vector<uint64_t> nextCounts;
+	};
+
+	CountingNfa() = default;
+	~CountingNfa() = default;
+
+	// with a budget, the positions left after counting are charged as NFA states
+	// and the tables as memory; over it, Compile fails with a valid regex and
+	// leaves an automaton that rejects every word
+	bool Compile(const std::string& regex, BudgetMeter* budget = nullptr);
+
+	bool CheckWord(const std::string& word, Scratch& scratch) const;
+	bool CheckWord(const char* word, size_t length, Scratch& scratch) const;
+
+	size_t getPositionCount() const;
+	size_t getCounterBits() const;
+	size_t getMemoryBytes() const;
+	const RegexParser& getParser() const; // why Compile rejected its regex
+
+private:
+	struct Counter
+	{
+		int position;
+		int width; // bit i: the count can be i + 1; for {m,} the last bit is a count of m or more
+		int exit; // lowest bit from which the position can be left
+		bool saturating;
+		size_t offset; // in the count words
+		size_t words;
+	};
+
+	bool CanLeave(int position, const uint64_t* counts) const;
+
+	RegexParser m_parser;
+	int m_position_count = 0;
+	size_t m_words = 0; // 64-bit words per position set
+	std::vector<ByteSet> m_bytes; // bytes entering each position
+	std::vector<int> m_follow_offset;
+	std::vector<int> m_follow; // positions that may come next, per position
+	std::vector<uint64_t> m_accepting;
+	std::vector<Counter> m_counters;
+	std::vector<int> m_counter_of; // per position, -1 when not counted
+	size_t m_count_words = 0;
+};
@@ -1,160 +1,306 @@
+﻿#include<algorithm>
+#include<array>
+#include<cctype>
+#include<chrono>
+
 #include "DeterministicFiniteAutomaton.h"
+#include "DfaFile.h"
 
 void DeterministicFiniteAutomaton::setStates(std::set<int> states)
 {
 	m_states = states;
+	m_table.clear();
 }
 
 void DeterministicFiniteAutomaton::setAlphabet(std::set<char> alphabet)
 {
 	m_alphabet = alphabet;
+	m_table.clear();
 }
 
 void DeterministicFiniteAutomaton::setTransitions(std::unordered_map<std::pair<int, char>, int, PairHash> transitions)
 {
 	m_transitions = transitions;
+	m_table.clear();
 }
 
 void DeterministicFiniteAutomaton::setInitialState(int init_state)
 {
 	m_init_state = init_state;
+	m_table.clear();
 }
 
 void DeterministicFiniteAutomaton::setFinalStates(std::set<int> final_states)
 {
 	m_final_states = final_states;
+	m_table.clear();
 }
 
 std::set<int>& DeterministicFiniteAutomaton::getStates()
 {
+	m_table.clear();
 	return m_states;
 }
 
 std::set<char>& DeterministicFiniteAutomaton::getAlphabet()
 {
+	m_table.clear();
 	return m_alphabet;
 }
 
 std::unordered_map<std::pair<int, char>, int, DeterministicFiniteAutomaton::PairHash>& DeterministicFiniteAutomaton::getTransitions()
 {
+	m_table.clear();
 	return m_transitions;
 }
 
 int& DeterministicFiniteAutomaton::getInitState()
 {
+	m_table.clear();
 	return m_init_state;
 }
 
 std::set<int>& DeterministicFiniteAutomaton::getFinalStates()
 {
+	m_table.clear();
 	return m_final_states;
 }
 
-struct SetHash {
-	template <typename T>
-	std::size_t operator()(const std::set<T>& s) const {
-		std::size_t hash_value = 0;
-		for (const T& elem : s) {
-			hash_value ^= std::hash<T>()(elem) + 0x9e3779b9 + (hash_value << 6) + (hash_value >> 2);
-		}
-		return hash_value;
-	}
-};
-
-std::set<int> lambda_closure(nfa AFN, const std::set<int>& states) {
-	std::set<int> closure = states;
-	std::queue<int> state_queue;
-	for (int state : states) {
-		state_queue.push(state);
-	}
-
-	while (!state_queue.empty()) {
-		int current_state = state_queue.front();
-		state_queue.pop();
-		auto transitions = AFN.getTransitions();
-		auto it = transitions.find({ current_state, 'L' });
-		if (it != transitions.end()) {
-			for (int next_state : it->second) {
-				if (closure.find(next_state) == closure.end()) {
-					closure.insert(next_state);
-					state_queue.push(next_state);
-				}
-			}
-		}
-	}
+DeterministicFiniteAutomaton DeterministicFiniteAutomaton::AFNtoAFD(const nfa& AFN, bool minimize)
+{
+	auto begin = std::chrono::steady_clock::now();
+	IndexedNfa indexed(AFN);
+	double index_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
 
-	return closure;
-};
+	DeterministicFiniteAutomaton result = AFNtoAFD(indexed, minimize);
+	result.m_timings.indexMs = index_ms;
+	return result;
+}
 
-DeterministicFiniteAutomaton DeterministicFiniteAutomaton::AFNtoAFD(nfa AFN)
+DeterministicFiniteAutomaton DeterministicFiniteAutomaton::AFNtoAFD(const IndexedNfa& AFN, bool minimize, BudgetMeter* budget)
 {
 	DeterministicFiniteAutomaton result;
+	ConstructionTimings timings;
+	auto begin = std::chrono::steady_clock::now();
+	auto lap = [&begin]() {
+		auto now = std::chrono::steady_clock::now();
+		double elapsed = std::chrono::duration<double, std::milli>(now - begin).count();
+		begin = now;
+		return elapsed;
+	};
+
+	int columns = AFN.columnCount;
+	std::vector<std::vector<int>> subsets;
+	std::vector<int> dfa_next;
+	// over budget, the result is left without states
+	auto over_budget = [budget]() { return budget && !budget->Deadline(); };
+	bool within_budget = AFN.Determinize(subsets, dfa_next, false, budget);
+	timings.subsetMs = lap();
+	if (!within_budget || over_budget()) {
+		result.m_timings = timings;
+		return result;
+	}
 
 	std::set<int> dfa_states;
 	std::unordered_map<std::pair<int, char>, int, PairHash> dfa_transitions;
 	std::set<int> dfa_final_states;
-	std::set<char> alphabet = AFN.getAlphabet();
+	std::set<char> alphabet(AFN.alphabet.begin(), AFN.alphabet.end());
+
+	for (int state = 0; state < (int)subsets.size(); state++) {
+		if (budget && !budget->Tick()) {
+			result.m_timings = timings;
+			return result;
+		}
+		dfa_states.insert(state);
+		for (int nfa_state : subsets[state])
+			if (AFN.accepting[nfa_state]) {
+				dfa_final_states.insert(state);
+				break;
+			}
+		for (char symbol : AFN.alphabet) {
+			int target = dfa_next[(size_t)state * columns + AFN.columns[(unsigned char)symbol]];
+			if (target != -1)
+				dfa_transitions[{ state, symbol }] = target;
+		}
+	}
+
+	result.setInitialState(0);
+	result.setStates(dfa_states);
+	result.setAlphabet(alphabet);
+	result.setTransitions(dfa_transitions);
+	result.setFinalStates(dfa_final_states);
+	result.BuildTransitionTable();
+	timings.tableMs = lap();
 
-	alphabet.erase('L');
+	if (minimize && !over_budget()) {
+		result.Minimize();
+		timings.minimizeMs = lap();
+	}
+	if (over_budget())
+		result = DeterministicFiniteAutomaton();
 
-	std::queue<std::set<int>> state_queue;
-	std::unordered_map<std::set<int>, int, SetHash> state_mapping;
-	int state_counter = 0;
+	result.m_timings = timings;
+	return result;
+}
 
-	std::set<int> nfa_init_state = { AFN.getInitState() };
-	std::set<int> dfa_init_state = lambda_closure(AFN, nfa_init_state);
+MinimizationReport DeterministicFiniteAutomaton::Minimize()
+{
+	const TransitionTable& table = getTransitionTable();
+	int state_count = table.dead + 1;
+	int columns = table.columnCount;
+
+	// predecessors grouped by (column, target)
+	std::vector<int> inverse_offset((size_t)columns * state_count + 1, 0);
+	for (int from = 0; from < state_count; from++)
+		for (int column = 0; column < columns; column++)
+			inverse_offset[(size_t)column * state_count + table.next[(size_t)from * columns + column] + 1]++;
+	for (size_t i = 1; i < inverse_offset.size(); i++)
+		inverse_offset[i] += inverse_offset[i - 1];
+	std::vector<int> inverse(inverse_offset.back());
+	std::vector<int> fill(inverse_offset.begin(), inverse_offset.end() - 1);
+	for (int from = 0; from < state_count; from++)
+		for (int column = 0; column < columns; column++)
+			inverse[fill[(size_t)column * state_count + table.next[(size_t)from * columns + column]]++] = from;
+
+	// partition: every block is a contiguous range of `elements`
+	std::vector<int> elements, location(state_count), block(state_count);
+	std::vector<int> block_begin, block_end, marked;
+	for (int accepting = 1; accepting >= 0; accepting--) {
+		int begin = (int)elements.size();
+		for (int state = 0; state < state_count; state++)
+			if (table.accepting[state] == accepting) {
+				location[state] = (int)elements.size();
+				block[state] = (int)block_begin.size();
+				elements.push_back(state);
+			}
+		if ((int)elements.size() > begin) {
+			block_begin.push_back(begin);
+			block_end.push_back((int)elements.size());
+			marked.push_back(0);
+		}
+	}
 
-	state_mapping[dfa_init_state] = state_counter++;
-	state_queue.push(dfa_init_state);
-	dfa_states.insert(state_mapping[dfa_init_state]);
-	result.setInitialState(state_mapping[dfa_init_state]);
+	std::vector<char> waiting((size_t)state_count * columns, 0);
+	std::vector<std::pair<int, int>> worklist;
+	int smallest = 0;
+	for (int b = 1; b < (int)block_begin.size(); b++)
+		if (block_end[b] - block_begin[b] < block_end[smallest] - block_begin[smallest])
+			smallest = b;
+	for (int column = 0; column < columns; column++) {
+		worklist.push_back({ smallest, column });
+		waiting[(size_t)smallest * columns + column] = 1;
+	}
 
-	while (!state_queue.empty()) {
-		std::set<int> current_set = state_queue.front();
-		state_queue.pop();
-		int current_dfa_state = state_mapping[current_set];
+	std::vector<int> predecessors, touched;
+	while (!worklist.empty()) {
+		auto [splitter, column] = worklist.back();
+		worklist.pop_back();
+		waiting[(size_t)splitter * columns + column] = 0;
 
-		for (char symbol : alphabet) {
-			std::set<int> next_states;
+		predecessors.clear();
+		for (int i = block_begin[splitter]; i < block_end[splitter]; i++) {
+			size_t key = (size_t)column * state_count + elements[i];
+			predecessors.insert(predecessors.end(), inverse.begin() + inverse_offset[key], inverse.begin() + inverse_offset[key + 1]);
+		}
 
-			for (int state : current_set) {
-				auto transitions = AFN.getTransitions();
-				auto it = transitions.find({ state, symbol });
-				if (it != transitions.end()) {
-					for (int next_state : it->second) {
-						next_states.insert(next_state);
-					}
-				}
-			}
+		touched.clear();
+		for (int state : predecessors) {
+			int b = block[state];
+			int target = block_begin[b] + marked[b];
+			if (location[state] < target)
+				continue;
+			if (marked[b] == 0)
+				touched.push_back(b);
+			int other = elements[target];
+			std::swap(elements[location[state]], elements[target]);
+			location[other] = location[state];
+			location[state] = target;
+			marked[b]++;
+		}
 
-			std::set<int> next_closure = lambda_closure(AFN, next_states);
+		for (int b : touched) {
+			int size = block_end[b] - block_begin[b];
+			if (marked[b] == size) {
+				marked[b] = 0;
+				continue;
+			}
 
-			if (!next_closure.empty()) {
-				if (state_mapping.find(next_closure) == state_mapping.end()) {
-					state_mapping[next_closure] = state_counter++;
-					state_queue.push(next_closure);
-					dfa_states.insert(state_mapping[next_closure]);
+			int split = (int)block_begin.size();
+			block_begin.push_back(block_begin[b]);
+			block_end.push_back(block_begin[b] + marked[b]);
+			marked.push_back(0);
+			block_begin[b] += marked[b];
+			marked[b] = 0;
+			for (int i = block_begin[split]; i < block_end[split]; i++)
+				block[elements[i]] = split;
+
+			int smaller = block_end[split] - block_begin[split] <= block_end[b] - block_begin[b] ? split : b;
+			for (int a = 0; a < columns; a++) {
+				if (waiting[(size_t)b * columns + a]) {
+					worklist.push_back({ split, a });
+					waiting[(size_t)split * columns + a] = 1;
+				}
+				else if (!waiting[(size_t)smaller * columns + a]) {
+					worklist.push_back({ smaller, a });
+					waiting[(size_t)smaller * columns + a] = 1;
 				}
-				dfa_transitions[{current_dfa_state, symbol}] = state_mapping[next_closure];
 			}
 		}
 	}
 
-	for (const auto& [nfa_set, dfa_state] : state_mapping) {
-		for (int nfa_state : nfa_set) {
-			if (nfa_state == AFN.getFinalState()) {
-				dfa_final_states.insert(dfa_state);
-				break;
+	// renumber the surviving blocks in BFS order from the initial state, dropping the dead block
+	int dead_block = block[table.dead];
+	std::vector<int> number(block_begin.size(), -1);
+	std::vector<int> representative;
+	if (block[table.start] != dead_block) {
+		number[block[table.start]] = 0;
+		representative.push_back(elements[block_begin[block[table.start]]]);
+	}
+	for (size_t i = 0; i < representative.size(); i++)
+		for (int column = 0; column < columns; column++) {
+			int b = block[table.next[(size_t)representative[i] * columns + column]];
+			if (b != dead_block && number[b] == -1) {
+				number[b] = (int)representative.size();
+				representative.push_back(elements[block_begin[b]]);
 			}
 		}
+
+	std::set<int> states;
+	std::unordered_map<std::pair<int, char>, int, PairHash> transitions;
+	std::set<int> final_states;
+	for (int state = 0; state < (int)representative.size(); state++) {
+		states.insert(state);
+		if (table.accepting[representative[state]])
+			final_states.insert(state);
+		for (char symbol : m_alphabet) {
+			int b = block[table.step(representative[state], (unsigned char)symbol)];
+			if (b != dead_block)
+				transitions[{ state, symbol }] = number[b];
+		}
 	}
+	if (states.empty())
+		states.insert(0);
 
-	result.setStates(dfa_states);
-	result.setAlphabet(alphabet);
-	result.setTransitions(dfa_transitions);
-	result.setFinalStates(dfa_final_states);
+	m_minimization.statesBefore = m_states.size();
+	m_minimization.statesAfter = states.size();
 
-	return result;
+	setStates(states);
+	setTransitions(transitions);
+	setFinalStates(final_states);
+	setInitialState(0);
+	BuildTransitionTable();
+
+	return m_minimization;
+}
+
+const MinimizationReport& DeterministicFiniteAutomaton::getMinimizationReport() const
+{
+	return m_minimization;
+}
+
+const ConstructionTimings& DeterministicFiniteAutomaton::getConstructionTimings() const
+{
+	return m_timings;
 }
 
 bool DeterministicFiniteAutomaton::VerifyAutomation()
@@ -180,11 +326,6 @@ bool DeterministicFiniteAutomaton::VerifyAutomation()
 	bool check = 0;
 	for (auto symbol : m_alphabet)
 	{
-		if (m_states.find(symbol) != m_states.end())
-		{
-			std::cout << std::endl << "State set and alphabet set have an element in common!" << std::endl;
-			return false;
-		}
 		auto it = m_transitions.find({ m_init_state, symbol });
 		if (it != m_transitions.end())
 			check = 1;
@@ -251,7 +392,154 @@ void DeterministicFiniteAutomaton::PrintAutomation(std::ostream& os)
 		os << final_state << std::endl;
 }
 
-bool DeterministicFiniteAutomaton::CheckWord(std::string word)
+void DeterministicFiniteAutomaton::EmitCpp(std::ostream& os, const std::string& function_name)
+{
+	// one label per state with a switch on the next byte, bytes grouped by target;
+	// acceptance is decided where the input ends, the dead state is every default
+	const TransitionTable& table = getTransitionTable();
+
+	os << "// Generated from a DeterministicFiniteAutomaton with " << table.dead << " states.\n";
+	os << "#include<cstddef>\n#include<string_view>\n\n";
+	os << "inline bool " << function_name << "(const char* word, std::size_t length)\n{\n";
+	os << "\tconst unsigned char* p = (const unsigned char*)word;\n";
+	os << "\tconst unsigned char* end = p + length;\n";
+	if (table.start == table.dead)
+		os << "\treturn false;\n";
+	else if (table.start != 0)
+		os << "\tgoto s" << table.start << ";\n";
+
+	// only targets of a goto get a label, an unused one would be warned about
+	std::vector<char> labeled(table.dead + 1, 0);
+	if (table.start != 0)
+		labeled[table.start] = 1;
+	for (int state = 0; state < table.dead; state++)
+		for (int column = 0; column < table.columnCount; column++)
+			labeled[table.next[(size_t)state * table.columnCount + column]] = 1;
+
+	for (int state = 0; state < table.dead; state++) {
+		if (labeled[state])
+			os << "s" << state << ":\n";
+		os << "\tif (p == end)\n\t\treturn " << (table.accepting[state] ? "true" : "false") << ";\n";
+		os << "\tswitch (*p++) {\n";
+
+		std::vector<std::vector<int>> symbols_to(table.dead);
+		for (int symbol = 0; symbol < 256; symbol++) {
+			int target = table.step(state, (unsigned char)symbol);
+			if (target != table.dead)
+				symbols_to[target].push_back(symbol);
+		}
+		for (int target = 0; target < table.dead; target++) {
+			if (symbols_to[target].empty())
+				continue;
+			os << "\t";
+			for (int symbol : symbols_to[target]) {
+				if (std::isalnum(symbol))
+					os << "case '" << (char)symbol << "': ";
+				else
+					os << "case " << symbol << ": ";
+			}
+			os << "goto s" << target << ";\n";
+		}
+		os << "\tdefault: return false;\n\t}\n";
+	}
+	os << "}\n";
+
+	os << "\ninline bool " << function_name << "(std::string_view word)\n{\n";
+	os << "\treturn " << function_name << "(word.data(), word.size());\n}\n";
+}
+
+bool DeterministicFiniteAutomaton::SaveBinary(const std::string& file_name)
+{
+	return SaveDfaFile(getTransitionTable(), file_name);
+}
+
+void DeterministicFiniteAutomaton::BuildTransitionTable()
+{
+	m_table.clear();
+
+	std::unordered_map<int, int> index;
+	for (int state : m_states)
+		index.emplace(state, (int)index.size());
+
+	int state_count = (int)index.size();
+	m_table.dead = state_count;
+
+	std::vector<std::vector<std::pair<int, int>>> rows(state_count); // (byte, target) per state
+	for (const auto& transition : m_transitions) {
+		auto from = index.find(transition.first.first);
+		auto to = index.find(transition.second);
+		if (from == index.end() || to == index.end())
+			continue;
+		rows[from->second].push_back({ (unsigned char)transition.first.second, to->second });
+	}
+
+	// byte equivalence classes: split the bytes state by state until two bytes
+	// share a column only if they lead to the same state everywhere
+	std::array<int, 256> byte_class{};
+	std::vector<int> target(256, m_table.dead);
+	std::unordered_map<long long, int> split;
+	int class_count = 1;
+	for (int state = 0; state < state_count && class_count < 256; state++) {
+		if (rows[state].empty())
+			continue;
+		for (auto [symbol, to] : rows[state])
+			target[symbol] = to;
+		split.clear();
+		for (int symbol = 0; symbol < 256; symbol++) {
+			long long key = (long long)byte_class[symbol] * (state_count + 1) + target[symbol];
+			byte_class[symbol] = split.emplace(key, (int)split.size()).first->second;
+		}
+		class_count = (int)split.size();
+		for (auto [symbol, to] : rows[state])
+			target[symbol] = m_table.dead;
+	}
+
+	m_table.columns = byte_class;
+	m_table.columnCount = class_count;
+	m_table.next.assign((size_t)(state_count + 1) * m_table.columnCount, m_table.dead);
+	m_table.accepting.assign(state_count + 1, 0);
+
+	for (int state = 0; state < state_count; state++)
+		for (auto [symbol, to] : rows[state])
+			m_table.next[(size_t)state * m_table.columnCount + byte_class[symbol]] = to;
+
+	for (int final_state : m_final_states) {
+		auto it = index.find(final_state);
+		if (it != index.end())
+			m_table.accepting[it->second] = 1;
+	}
+
+	auto init = index.find(m_init_state);
+	m_table.start = init != index.end() ? init->second : m_table.dead;
+}
+
+const TransitionTable& DeterministicFiniteAutomaton::getTransitionTable()
+{
+	if (m_table.empty())
+		BuildTransitionTable();
+	return m_table;
+}
+
+bool DeterministicFiniteAutomaton::CheckWord(const std::string& word)
+{
+	getTransitionTable();
+	return CheckWord(word.data(), word.size());
+}
+
+bool DeterministicFiniteAutomaton::CheckWord(const char* word, size_t length) const
+{
+	if (m_table.empty())
+		return CheckWordUsingMap(std::string(word, length));
+
+	return m_table.view().CheckWord(word, length);
+}
+
+void DeterministicFiniteAutomaton::CheckWords(std::span<const std::string_view> words, std::vector<uint64_t>& accepted)
+{
+	getTransitionTable().view().CheckWords(words, accepted);
+}
+
+bool DeterministicFiniteAutomaton::CheckWordUsingMap(const std::string& word) const
 {
 	int current_state = m_init_state;
 	for (char symbol : word) {
@@ -8,9 +8,25 @@
 #include<queue>
 
 #include "NondeterministicFiniteAutomaton.h"
+#include "IndexedNfa.h"
+#include "TransitionTable.h"
 
 typedef NondeterministicFiniteAutomaton nfa;
 
+struct MinimizationReport
+{
+	size_t statesBefore = 0;
+	size_t statesAfter = 0;
+};
+
+struct ConstructionTimings
+{
+	double indexMs = 0; // NFA renumbering and lambda-closures
+	double subsetMs = 0;
+	double tableMs = 0;
+	double minimizeMs = 0;
+};
+
 class DeterministicFiniteAutomaton
 {
 
@@ -30,6 +46,10 @@ private:
 	int m_init_state; //q_0
 	std::set<int> m_final_states; //F
 
+	TransitionTable m_table; // dense form of δ, rebuilt lazily after any change
+	MinimizationReport m_minimization;
+	ConstructionTimings m_timings;
+
 public:
 	DeterministicFiniteAutomaton() = default;
 	~DeterministicFiniteAutomaton() = default;
@@ -46,9 +66,20 @@ public:
 	int& getInitState();
 	std::set<int>& getFinalStates();
 
-	DeterministicFiniteAutomaton AFNtoAFD(nfa regex);
+	DeterministicFiniteAutomaton AFNtoAFD(const nfa& regex, bool minimize = true);
+	DeterministicFiniteAutomaton AFNtoAFD(const IndexedNfa& regex, bool minimize = true, BudgetMeter* budget = nullptr); // no states when over budget
+	MinimizationReport Minimize();
+	const MinimizationReport& getMinimizationReport() const;
+	const ConstructionTimings& getConstructionTimings() const;
 	bool VerifyAutomation();
 	void PrintAutomation(std::ostream& os);
-	bool CheckWord(std::string word);
+	void EmitCpp(std::ostream& os, const std::string& function_name = "match");
+	bool SaveBinary(const std::string& file_name);
+	void BuildTransitionTable();
+	const TransitionTable& getTransitionTable();
+	bool CheckWord(const std::string& word);
+	bool CheckWord(const char* word, size_t length) const;
+	void CheckWords(std::span<const std::string_view> words, std::vector<uint64_t>& accepted);
+	bool CheckWordUsingMap(const std::string& word) const;
 };
 
@@ -0,0 +1,206 @@
+#include<cstring>
+#include<fstream>
+#include<vector>
+
+#ifdef _WIN32
+#include<windows.h>
+#else
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
+#include "DfaFile.h"
+
+static_assert(sizeof(int) == sizeof(int32_t), "the mapped table is read as int");
+
+static uint64_t fnv1a(const unsigned char* data, size_t size)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool SaveDfaFile(const TransitionTable& table, const std::string& file_name)
+{
+	if (table.empty())
+		return false;
+
+	DfaFileHeader header = {};
+	std::memcpy(header.magic, kDfaFileMagic, sizeof(header.magic));
+	header.version = kDfaFileVersion;
+	header.stateCount = (uint32_t)table.accepting.size();
+	header.columnCount = (uint32_t)table.columnCount;
+	header.start = (uint32_t)table.start;
+	header.dead = (uint32_t)table.dead;
+	header.acceptingBytes = (header.stateCount + 3) / 4 * 4;
+
+	std::vector<unsigned char> payload(sizeof(int32_t) * 256 + header.acceptingBytes + sizeof(int32_t) * table.next.size(), 0);
+	unsigned char* position = payload.data();
+	std::memcpy(position, table.columns.data(), sizeof(int32_t) * 256);
+	position += sizeof(int32_t) * 256;
+	std::memcpy(position, table.accepting.data(), table.accepting.size());
+	position += header.acceptingBytes;
+	std::memcpy(position, table.next.data(), sizeof(int32_t) * table.next.size());
+	header.checksum = fnv1a(payload.data(), payload.size());
+
+	std::ofstream fout(file_name, std::ios::binary);
+	fout.write((const char*)&header, sizeof(header));
+	fout.write((const char*)payload.data(), payload.size());
+	return (bool)fout;
+}
+
+bool isDfaFile(const std::string& file_name)
+{
+	char magic[sizeof(kDfaFileMagic)] = {};
+	std::ifstream fin(file_name, std::ios::binary);
+	fin.read(magic, sizeof(magic));
+	return fin && std::memcmp(magic, kDfaFileMagic, sizeof(magic)) == 0;
+}
+
+MappedDfa::~MappedDfa()
+{
+	Close();
+}
+
+bool MappedDfa::Open(const std::string& file_name, bool verify)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	m_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		Close();
+		return false;
+	}
+	m_size = (size_t)size.QuadPart;
+
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr) {
+		Close();
+		return false;
+	}
+	m_data = (const unsigned char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	m_file = open(file_name.c_str(), O_RDONLY);
+	if (m_file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(m_file, &info) != 0 || info.st_size == 0) {
+		Close();
+		return false;
+	}
+	m_size = (size_t)info.st_size;
+
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_file, 0);
+	m_data = data == MAP_FAILED ? nullptr : (const unsigned char*)data;
+#endif
+
+	if (m_data == nullptr || !Validate(verify)) {
+		Close();
+		return false;
+	}
+
+	const DfaFileHeader* header = (const DfaFileHeader*)m_data;
+	const unsigned char* position = m_data + sizeof(DfaFileHeader);
+	m_view.columns = (const int*)position;
+	position += sizeof(int32_t) * 256;
+	m_view.accepting = position;
+	position += header->acceptingBytes;
+	m_view.next = (const int*)position;
+	m_view.columnCount = (int)header->columnCount;
+	m_view.start = (int)header->start;
+	m_view.dead = (int)header->dead;
+	return true;
+}
+
+bool MappedDfa::Validate(bool verify) const
+{
+	if (m_size < sizeof(DfaFileHeader))
+		return false;
+
+	const DfaFileHeader* header = (const DfaFileHeader*)m_data;
+	if (std::memcmp(header->magic, kDfaFileMagic, sizeof(header->magic)) != 0 || header->version != kDfaFileVersion)
+		return false;
+	if (header->stateCount == 0 || header->columnCount == 0 || header->start >= header->stateCount || header->dead >= header->stateCount)
+		return false;
+	if (header->acceptingBytes < header->stateCount || header->acceptingBytes % 4 != 0)
+		return false;
+
+	uint64_t payload = sizeof(int32_t) * 256ull + header->acceptingBytes + sizeof(int32_t) * (uint64_t)header->stateCount * header->columnCount;
+	if (m_size != sizeof(DfaFileHeader) + payload)
+		return false;
+
+	if (!verify)
+		return true;
+
+	if (fnv1a(m_data + sizeof(DfaFileHeader), (size_t)payload) != header->checksum)
+		return false;
+
+	const int32_t* columns = (const int32_t*)(m_data + sizeof(DfaFileHeader));
+	for (int i = 0; i < 256; i++)
+		if (columns[i] < 0 || (uint32_t)columns[i] >= header->columnCount)
+			return false;
+
+	const int32_t* next = (const int32_t*)(m_data + sizeof(DfaFileHeader) + sizeof(int32_t) * 256 + header->acceptingBytes);
+	for (uint64_t i = 0; i < (uint64_t)header->stateCount * header->columnCount; i++)
+		if (next[i] < 0 || (uint32_t)next[i] >= header->stateCount)
+			return false;
+
+	return true;
+}
+
+void MappedDfa::Close()
+{
+#ifdef _WIN32
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file)
+		CloseHandle(m_file);
+	m_mapping = nullptr;
+	m_file = nullptr;
+#else
+	if (m_data)
+		munmap((void*)m_data, m_size);
+	if (m_file >= 0)
+		close(m_file);
+	m_file = -1;
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_view = TransitionTableView();
+}
+
+bool MappedDfa::isOpen() const
+{
+	return m_data != nullptr;
+}
+
+bool MappedDfa::CheckWord(const std::string& word) const
+{
+	return CheckWord(word.data(), word.size());
+}
+
+bool MappedDfa::CheckWord(const char* word, size_t length) const
+{
+	if (m_data == nullptr)
+		return false;
+	return m_view.CheckWord(word, length);
+}
+
+TransitionTableView MappedDfa::view() const
+{
+	return m_view;
+}
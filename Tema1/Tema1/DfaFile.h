@@ -0,0 +1,60 @@
+#pragma once
+
+#include<cstdint>
+#include<string>
+
+#include "TransitionTable.h"
+
+// Binary layout of a compiled DFA, native byte order:
+//   DfaFileHeader
+//   int32 columns[256]              byte -> column
+//   uint8 accepting[acceptingBytes] one flag per state, padded to 4 bytes
+//   int32 next[stateCount * columnCount]
+struct DfaFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t stateCount; // rows, including the dead state
+	uint32_t columnCount;
+	uint32_t start;
+	uint32_t dead;
+	uint32_t acceptingBytes;
+	uint64_t checksum; // FNV-1a over everything after the header
+};
+
+constexpr char kDfaFileMagic[8] = { 'L', 'F', 'C', 'D', 'F', 'A', 0, 0 };
+constexpr uint32_t kDfaFileVersion = 1;
+
+bool SaveDfaFile(const TransitionTable& table, const std::string& file_name);
+bool isDfaFile(const std::string& file_name);
+
+// Maps a saved DFA into memory and matches directly on the mapped table.
+class MappedDfa
+{
+public:
+	MappedDfa() = default;
+	~MappedDfa();
+	MappedDfa(const MappedDfa&) = delete;
+	MappedDfa& operator=(const MappedDfa&) = delete;
+
+	bool Open(const std::string& file_name, bool verify = true);
+	void Close();
+	bool isOpen() const;
+
+	bool CheckWord(const std::string& word) const;
+	bool CheckWord(const char* word, size_t length) const;
+	TransitionTableView view() const;
+
+private:
+	bool Validate(bool verify) const;
+
+	const unsigned char* m_data = nullptr;
+	size_t m_size = 0;
+	TransitionTableView m_view;
+#ifdef _WIN32
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+};
@@ -0,0 +1,228 @@
+#include<algorithm>
+
+#include "GlushkovBuilder.h"
+
+void GlushkovBuilder::Merge(std::vector<int>& a, std::vector<int>& b)
+{
+	if (a.size() < b.size())
+		a.swap(b);
+	a.insert(a.end(), b.begin(), b.end());
+	std::vector<int>().swap(b);
+}
+
+void GlushkovBuilder::Follow(const std::vector<int>& from, const std::vector<int>& to)
+{
+	for (int q : from)
+		for (int p : to)
+			m_follow.push_back({ q, p });
+}
+
+void GlushkovBuilder::Concatenate(Sets& a, Sets& b)
+{
+	Follow(a.last, b.first);
+	if (a.nullable)
+		Merge(a.first, b.first);
+	if (b.nullable)
+		Merge(b.last, a.last);
+	a.last.swap(b.last);
+	a.nullable = a.nullable && b.nullable;
+	b = Sets();
+}
+
+void GlushkovBuilder::Alternate(Sets& a, Sets& b)
+{
+	a.nullable = a.nullable || b.nullable;
+	Merge(a.first, b.first);
+	Merge(a.last, b.last);
+	b = Sets();
+}
+
+void GlushkovBuilder::Star(Sets& a)
+{
+	Follow(a.last, a.first);
+	a.nullable = true;
+}
+
+GlushkovBuilder::Sets GlushkovBuilder::Copy(const Sets& sets, const Span& span)
+{
+	// a subtree only links positions of its own span
+	int shift = (int)m_symbol.size() - span.positionBegin;
+	for (int position = span.positionBegin; position < span.positionEnd; position++)
+		m_symbol.push_back(m_symbol[position]);
+	for (size_t i = span.followBegin; i < span.followEnd; i++) {
+		auto [from, to] = m_follow[i];
+		m_follow.push_back({ from + shift, to + shift });
+	}
+	if (m_counted)
+		for (size_t i = span.countedBegin; i < span.countedEnd; i++) {
+			CountedPosition copy = (*m_counted)[i];
+			copy.position += shift;
+			m_counted->push_back(copy);
+		}
+
+	Sets copy = { sets.nullable, sets.first, sets.last };
+	for (int& position : copy.first)
+		position += shift;
+	for (int& position : copy.last)
+		position += shift;
+	return copy;
+}
+
+void GlushkovBuilder::Repeat(Sets& a, const Span& span, const RegexRepeat& repeat)
+{
+	bool unbounded = repeat.max == RegexRepeat::kUnbounded;
+	int count = unbounded ? std::max(repeat.min, 1) : repeat.max;
+	if (count == 0) {
+		a = Sets();
+		a.nullable = true;
+		return;
+	}
+	if (unbounded && repeat.min == 0) {
+		Star(a);
+		return;
+	}
+
+	// every copy is taken before any of them is linked, while the operand is untouched
+	std::vector<Sets> copies(count);
+	for (int i = 1; i < count; i++)
+		copies[i] = Copy(a, span);
+	copies[0] = std::move(a);
+
+	if (unbounded)
+		Follow(copies.back().last, copies.back().first);
+	else if (repeat.min < count) {
+		// the optional copies nest, a(a(a)?)?, so first sets do not grow with the count
+		for (int i = count - 2; i >= repeat.min; i--) {
+			copies[i + 1].nullable = true;
+			Concatenate(copies[i], copies[i + 1]);
+		}
+		copies[repeat.min].nullable = true;
+		count = repeat.min + 1;
+	}
+
+	for (int i = 1; i < count; i++)
+		Concatenate(copies[0], copies[i]);
+	a = std::move(copies[0]);
+}
+
+bool GlushkovBuilder::SingleByte(const RegexAst& ast, int node, ByteSet& bytes) const
+{
+	// symbols, classes and alternations of them: every word is one byte
+	bytes.reset();
+	std::vector<int> stack = { node };
+	while (!stack.empty()) {
+		const RegexNode& current = ast.nodes[stack.back()];
+		stack.pop_back();
+		if (current.kind == RegexNode::Kind::Symbol)
+			bytes.set(current.left);
+		else if (current.kind == RegexNode::Kind::Class)
+			bytes |= ast.classes[current.left];
+		else if (current.kind == RegexNode::Kind::Alternation) {
+			stack.push_back(current.left);
+			stack.push_back(current.right);
+		}
+		else
+			return false;
+	}
+	return true;
+}
+
+bool GlushkovBuilder::Build(const RegexAst& ast, NfaGraph& graph, std::vector<CountedPosition>* counted)
+{
+	if (ast.nodes.empty())
+		return false;
+
+	size_t node_count = ast.nodes.size();
+	m_sets.assign(node_count, Sets());
+	m_symbol.assign(1, NfaGraph::kLambda);
+	m_follow.clear();
+	m_classes = ast.classes;
+	m_counted = counted;
+	if (m_counted)
+		m_counted->clear();
+
+	// operands come before their node; every set is moved up into its parent once
+	std::vector<Span> spans(node_count);
+	for (size_t i = 0; i < node_count; i++) {
+		const RegexNode& node = ast.nodes[i];
+		bool leaf = node.kind == RegexNode::Kind::Symbol || node.kind == RegexNode::Kind::Class;
+		size_t counted_size = m_counted ? m_counted->size() : 0;
+		Span& span = spans[i];
+		span.positionBegin = leaf ? (int)m_symbol.size() : spans[node.left].positionBegin;
+		span.followBegin = leaf ? m_follow.size() : spans[node.left].followBegin;
+		span.countedBegin = leaf ? counted_size : spans[node.left].countedBegin;
+
+		switch (node.kind) {
+		case RegexNode::Kind::Symbol:
+		case RegexNode::Kind::Class: {
+			int position = (int)m_symbol.size();
+			m_symbol.push_back(node.kind == RegexNode::Kind::Symbol ? node.left : NfaGraph::kClass + node.left);
+			m_sets[i].first = { position };
+			m_sets[i].last = { position };
+			break;
+		}
+		case RegexNode::Kind::Alternation:
+			Alternate(m_sets[node.left], m_sets[node.right]);
+			m_sets[i] = std::move(m_sets[node.left]);
+			break;
+		case RegexNode::Kind::Concatenation:
+			Concatenate(m_sets[node.left], m_sets[node.right]);
+			m_sets[i] = std::move(m_sets[node.left]);
+			break;
+		case RegexNode::Kind::Star:
+			Star(m_sets[node.left]);
+			m_sets[i] = std::move(m_sets[node.left]);
+			break;
+		case RegexNode::Kind::Repeat: {
+			const RegexRepeat& repeat = ast.repeats[node.right];
+			bool copied = repeat.max == RegexRepeat::kUnbounded ? repeat.min > 1 : repeat.max > 1;
+			ByteSet bytes;
+			if (m_counted && copied && SingleByte(ast, node.left, bytes)) {
+				// the operand's own positions are left unreachable
+				int position = (int)m_symbol.size();
+				m_symbol.push_back(NfaGraph::kClass + (int)m_classes.size());
+				m_classes.push_back(bytes);
+				m_counted->push_back({ position, repeat.min, repeat.max });
+				m_sets[i].nullable = repeat.min == 0;
+				m_sets[i].first = { position };
+				m_sets[i].last = { position };
+				m_sets[node.left] = Sets();
+				break;
+			}
+			Repeat(m_sets[node.left], spans[node.left], repeat);
+			m_sets[i] = std::move(m_sets[node.left]);
+			break;
+		}
+		}
+
+		span.positionEnd = (int)m_symbol.size();
+		span.followEnd = m_follow.size();
+		span.countedEnd = m_counted ? m_counted->size() : 0;
+	}
+
+	const Sets& root = m_sets[ast.root()];
+	for (int position : root.first)
+		m_follow.push_back({ 0, position });
+	std::sort(m_follow.begin(), m_follow.end());
+	m_follow.erase(std::unique(m_follow.begin(), m_follow.end()), m_follow.end());
+
+	graph.stateCount = (int)m_symbol.size();
+	graph.start = 0;
+	graph.accepting.assign(graph.stateCount, 0);
+	graph.accepting[0] = root.nullable;
+	for (int position : root.last)
+		graph.accepting[position] = 1;
+
+	graph.edgeOffset.assign(graph.stateCount + 1, 0);
+	graph.edges.clear();
+	graph.edges.reserve(m_follow.size());
+	for (auto [from, to] : m_follow) {
+		graph.edgeOffset[from + 1]++;
+		graph.edges.push_back({ m_symbol[to], to });
+	}
+	for (int state = 0; state < graph.stateCount; state++)
+		graph.edgeOffset[state + 1] += graph.edgeOffset[state];
+	graph.classes = m_classes;
+	m_counted = nullptr;
+	return true;
+}
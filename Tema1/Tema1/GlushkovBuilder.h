@@ -0,0 +1,74 @@
+#pragma once
+
+#include<utility>
+#include<vector>
+
+#include "NfaGraph.h"
+#include "RegexParser.h"
+
+// A position standing for a whole repetition of a single-byte operand, such
+// as [0-9]{2,4} or (a|b){1,1000}: it is entered on any byte of the operand and
+// stays entered while its count is at most max. It can only be left, or accept,
+// once the count has reached min.
+struct CountedPosition
+{
+	int position;
+	int min;
+	int max; // RegexRepeat::kUnbounded
+};
+
+// Glushkov (position) automaton straight from the AST: state 0 is the initial
+// state and every symbol or class occurrence is one more state, entered only
+// on that symbol. Transitions come from the first, last and follow sets of the
+// positions, so there is not a single lambda edge to close over later, at the
+// price of up to quadratically many symbol edges (e.g. under nested stars).
+// A repetition copies the positions and follow pairs of its operand once per
+// copy, unless counted positions are asked for (see CountingNfa).
+class GlushkovBuilder
+{
+public:
+	GlushkovBuilder() = default;
+	~GlushkovBuilder() = default;
+
+	// with counted, repetitions of single-byte operands are one CountedPosition
+	// each instead of a copy per count; graph then holds no edge for counting
+	bool Build(const RegexAst& ast, NfaGraph& graph, std::vector<CountedPosition>* counted = nullptr);
+
+private:
+	struct Sets
+	{
+		bool nullable = false;
+		std::vector<int> first; // positions a word of the node can begin with
+		std::vector<int> last; // positions it can end with
+	};
+
+	// the positions, follow pairs and counted positions an AST subtree added
+	struct Span
+	{
+		int positionBegin;
+		int positionEnd;
+		size_t followBegin;
+		size_t followEnd;
+		size_t countedBegin;
+		size_t countedEnd;
+	};
+
+	// merges b into a, whichever order copies less, and frees b
+	static void Merge(std::vector<int>& a, std::vector<int>& b);
+	void Follow(const std::vector<int>& from, const std::vector<int>& to);
+
+	// each of these leaves its result in a and frees b
+	void Concatenate(Sets& a, Sets& b);
+	void Alternate(Sets& a, Sets& b);
+	void Star(Sets& a);
+
+	Sets Copy(const Sets& sets, const Span& span);
+	void Repeat(Sets& a, const Span& span, const RegexRepeat& repeat);
+	bool SingleByte(const RegexAst& ast, int node, ByteSet& bytes) const;
+
+	std::vector<Sets> m_sets;
+	std::vector<int> m_symbol; // edge symbol into each position
+	std::vector<std::pair<int, int>> m_follow; // (position, position that may come next)
+	std::vector<ByteSet> m_classes;
+	std::vector<CountedPosition>* m_counted = nullptr;
+};
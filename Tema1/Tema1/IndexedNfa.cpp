@@ -0,0 +1,188 @@
+#include<algorithm>
+#include<map>
+#include<unordered_map>
+
+#include "IndexedNfa.h"
+
+IndexedNfa::IndexedNfa(const NondeterministicFiniteAutomaton& AFN)
+{
+	std::unordered_map<int, int> index;
+	for (int state : AFN.getStates())
+		index.emplace(state, (int)index.size());
+	index.emplace(AFN.getInitState(), (int)index.size());
+	index.emplace(AFN.getFinalState(), (int)index.size());
+
+	stateCount = (int)index.size();
+	initial = index[AFN.getInitState()];
+	accepting.assign(stateCount, 0);
+	accepting[index[AFN.getFinalState()]] = 1;
+
+	std::vector<std::vector<int>> lambda(stateCount);
+	std::vector<std::vector<std::pair<int, int>>> byte_moves(256);
+	for (const auto& [rule, destinations] : AFN.getTransitions()) {
+		int from = index[rule.first];
+		for (int destination : destinations) {
+			if (rule.second == NondeterministicFiniteAutomaton::kLambda)
+				lambda[from].push_back(index[destination]);
+			else
+				byte_moves[(unsigned char)rule.second].push_back({ from, index[destination] });
+		}
+	}
+
+	Index(lambda, byte_moves);
+}
+
+IndexedNfa::IndexedNfa(const NfaGraph& graph)
+{
+	stateCount = graph.stateCount;
+	initial = graph.start;
+	accepting = graph.accepting;
+
+	std::vector<std::vector<int>> lambda(stateCount);
+	std::vector<std::vector<std::pair<int, int>>> byte_moves(256);
+	for (int state = 0; state < stateCount; state++)
+		for (int i = graph.edgeOffset[state]; i < graph.edgeOffset[state + 1]; i++) {
+			const NfaEdge& edge = graph.edges[i];
+			if (edge.symbol == NfaGraph::kLambda)
+				lambda[state].push_back(edge.to);
+			else if (edge.symbol < NfaGraph::kClass)
+				byte_moves[edge.symbol].push_back({ state, edge.to });
+			else {
+				const auto& bytes = graph.classes[edge.symbol - NfaGraph::kClass];
+				for (int symbol = 0; symbol < 256; symbol++)
+					if (bytes[symbol])
+						byte_moves[symbol].push_back({ state, edge.to });
+			}
+		}
+
+	Index(lambda, byte_moves);
+}
+
+void IndexedNfa::Index(std::vector<std::vector<int>>& lambda, std::vector<std::vector<std::pair<int, int>>>& byte_moves)
+{
+	// byte equivalence classes: bytes with identical (from, to) move lists are one column
+	std::map<std::vector<std::pair<int, int>>, int> column_of;
+	std::vector<int> representative;
+	columns.fill(-1);
+	alphabet.clear();
+	for (int symbol = 0; symbol < 256; symbol++) {
+		if (byte_moves[symbol].empty())
+			continue;
+		std::sort(byte_moves[symbol].begin(), byte_moves[symbol].end());
+		auto [it, inserted] = column_of.emplace(byte_moves[symbol], (int)representative.size());
+		if (inserted)
+			representative.push_back(symbol);
+		columns[symbol] = it->second;
+		alphabet.push_back((char)symbol);
+	}
+	columnCount = (int)representative.size();
+
+	std::vector<std::vector<std::pair<int, int>>> symbol_moves(stateCount);
+	for (int column = 0; column < columnCount; column++)
+		for (auto [from, to] : byte_moves[representative[column]])
+			symbol_moves[from].push_back({ column, to });
+
+	moveOffset.assign(stateCount + 1, 0);
+	for (int state = 0; state < stateCount; state++) {
+		std::sort(symbol_moves[state].begin(), symbol_moves[state].end());
+		moves.insert(moves.end(), symbol_moves[state].begin(), symbol_moves[state].end());
+		moveOffset[state + 1] = (int)moves.size();
+	}
+
+	closureOffset.assign(stateCount + 1, 0);
+	std::vector<int> seen(stateCount, -1);
+	std::vector<int> stack;
+	for (int state = 0; state < stateCount; state++) {
+		size_t begin = closures.size();
+		stack.push_back(state);
+		seen[state] = state;
+		while (!stack.empty()) {
+			int current = stack.back();
+			stack.pop_back();
+			closures.push_back(current);
+			for (int next : lambda[current]) {
+				if (seen[next] != state) {
+					seen[next] = state;
+					stack.push_back(next);
+				}
+			}
+		}
+		std::sort(closures.begin() + begin, closures.end());
+		closureOffset[state + 1] = (int)closures.size();
+	}
+}
+
+bool IndexedNfa::Determinize(std::vector<std::vector<int>>& subsets, std::vector<int>& next, bool unanchored, BudgetMeter* budget) const
+{
+	int column_count = columnCount;
+	std::unordered_map<std::vector<int>, int, SubsetHash> state_mapping;
+	std::vector<const std::vector<int>*> interned;
+	next.clear();
+
+	// a state costs its key, the node around it (about a vector, an int and two
+	// pointers) and its row of transitions
+	size_t bytes = 0;
+	bool within_budget = true;
+	auto intern = [&](std::vector<int>& subset) {
+		auto [it, inserted] = state_mapping.emplace(std::move(subset), (int)interned.size());
+		if (inserted) {
+			interned.push_back(&it->first);
+			next.resize(next.size() + column_count, -1);
+			if (budget) {
+				bytes += it->first.size() * sizeof(int) + sizeof(std::vector<int>) + 3 * sizeof(void*) + column_count * sizeof(int);
+				within_budget = within_budget && budget->DfaStates(interned.size(), bytes);
+			}
+		}
+		return it->second;
+	};
+
+	std::vector<int> initial_closure(closureBegin(initial), closureEnd(initial));
+	intern(initial_closure);
+
+	std::vector<std::vector<int>> targets(column_count);
+	std::vector<int> seen(stateCount, -1);
+	int generation = 0;
+
+	// subsets are numbered in discovery order, so walking the ids is a BFS
+	for (size_t current = 0; current < interned.size(); current++) {
+		if (budget && !(within_budget && budget->Tick())) {
+			subsets.clear();
+			next.clear();
+			return false;
+		}
+
+		for (int nfa_state : *interned[current])
+			for (auto move = movesBegin(nfa_state); move != movesEnd(nfa_state); ++move)
+				targets[move->first].push_back(move->second);
+
+		for (int column = 0; column < column_count; column++) {
+			if (targets[column].empty() && !unanchored)
+				continue;
+
+			generation++;
+			std::vector<int> next_closure;
+			if (unanchored)
+				for (auto it = closureBegin(initial); it != closureEnd(initial); ++it) {
+					seen[*it] = generation;
+					next_closure.push_back(*it);
+				}
+			for (int target : targets[column])
+				for (auto it = closureBegin(target); it != closureEnd(target); ++it)
+					if (seen[*it] != generation) {
+						seen[*it] = generation;
+						next_closure.push_back(*it);
+					}
+			targets[column].clear();
+
+			std::sort(next_closure.begin(), next_closure.end());
+			next[current * column_count + column] = intern(next_closure);
+		}
+	}
+
+	subsets.assign(interned.size(), {});
+	while (!state_mapping.empty()) {
+		auto node = state_mapping.extract(state_mapping.begin());
+		subsets[node.mapped()] = std::move(node.key());
+	}
+	return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include<array>
+#include<utility>
+#include<vector>
+
+#include "CompileBudget.h"
+#include "NondeterministicFiniteAutomaton.h"
+#include "NfaGraph.h"
+
+struct SubsetHash {
+	std::size_t operator()(const std::vector<int>& subset) const {
+		std::size_t hash_value = subset.size();
+		for (int state : subset) {
+			hash_value ^= std::hash<int>()(state) + 0x9e3779b9 + (hash_value << 6) + (hash_value >> 2);
+		}
+		return hash_value;
+	}
+};
+
+// NFA renumbered to 0..stateCount-1 with lambda-closures and symbol moves
+// precomputed once, in CSR form.
+struct IndexedNfa
+{
+	int stateCount = 0;
+	int initial = 0;
+	std::vector<unsigned char> accepting;
+	std::vector<char> alphabet; // bytes on some edge, ascending
+	std::array<int, 256> columns{}; // byte -> equivalence class, -1 when on no edge
+	int columnCount = 0; // bytes with the same moves from every state share a column
+
+	std::vector<int> closureOffset;
+	std::vector<int> closures; // each closure sorted, contains its own state
+
+	std::vector<int> moveOffset;
+	std::vector<std::pair<int, int>> moves; // (column, target), sorted by column
+
+	IndexedNfa() = default;
+	explicit IndexedNfa(const NondeterministicFiniteAutomaton& AFN);
+	explicit IndexedNfa(const NfaGraph& graph);
+
+	// Subset construction. subsets[i] is the sorted NFA state set of DFA state i
+	// (0 is the initial one), next[i * columnCount + column] its successor or -1.
+	// unanchored adds the initial closure to every subset, as if the automaton
+	// were restarted on each symbol; no successor is then ever -1.
+	// With a budget, gives up (false, both outputs empty) as soon as it is exceeded.
+	bool Determinize(std::vector<std::vector<int>>& subsets, std::vector<int>& next, bool unanchored = false, BudgetMeter* budget = nullptr) const;
+
+private:
+	void Index(std::vector<std::vector<int>>& lambda, std::vector<std::vector<std::pair<int, int>>>& byte_moves);
+
+public:
+	const int* closureBegin(int state) const { return closures.data() + closureOffset[state]; }
+	const int* closureEnd(int state) const { return closures.data() + closureOffset[state + 1]; }
+	const std::pair<int, int>* movesBegin(int state) const { return moves.data() + moveOffset[state]; }
+	const std::pair<int, int>* movesEnd(int state) const { return moves.data() + moveOffset[state + 1]; }
+};
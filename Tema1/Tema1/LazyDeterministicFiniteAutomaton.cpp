@@ -0,0 +1,120 @@
+#include<algorithm>
+
+#include "LazyDeterministicFiniteAutomaton.h"
+
+LazyDeterministicFiniteAutomaton::LazyDeterministicFiniteAutomaton(const NondeterministicFiniteAutomaton& AFN, size_t max_states)
+	: LazyDeterministicFiniteAutomaton(IndexedNfa(AFN), max_states)
+{
+}
+
+LazyDeterministicFiniteAutomaton::LazyDeterministicFiniteAutomaton(const IndexedNfa& indexed, size_t max_states)
+	: m_nfa(indexed), m_generation(0), m_start(0), m_max_states(std::max<size_t>(max_states, 2)), m_flushes(0)
+{
+	m_seen.assign(m_nfa.stateCount, 0);
+	Flush();
+	m_flushes = 0;
+}
+
+void LazyDeterministicFiniteAutomaton::Flush()
+{
+	m_subsets.clear();
+	m_state_mapping.clear();
+	m_next.clear();
+	m_accepting.clear();
+	m_flushes++;
+
+	std::vector<int> initial(m_nfa.closureBegin(m_nfa.initial), m_nfa.closureEnd(m_nfa.initial));
+	m_start = AddState(initial);
+}
+
+int LazyDeterministicFiniteAutomaton::AddState(const std::vector<int>& subset)
+{
+	auto it = m_state_mapping.find(subset);
+	if (it != m_state_mapping.end())
+		return it->second;
+
+	int state = (int)m_subsets.size();
+	m_state_mapping.emplace(subset, state);
+	m_subsets.push_back(subset);
+	m_next.resize(m_next.size() + m_nfa.columnCount, kUnknown);
+
+	bool accepting = false;
+	for (int nfa_state : subset)
+		accepting = accepting || m_nfa.accepting[nfa_state];
+	m_accepting.push_back(accepting);
+
+	return state;
+}
+
+int LazyDeterministicFiniteAutomaton::ComputeTransition(int state, int column)
+{
+	if (++m_generation == 0) {
+		std::fill(m_seen.begin(), m_seen.end(), 0);
+		m_generation = 1;
+	}
+
+	std::vector<int> next_states;
+	for (int nfa_state : m_subsets[state]) {
+		for (auto move = m_nfa.movesBegin(nfa_state); move != m_nfa.movesEnd(nfa_state); ++move) {
+			if (move->first != column)
+				continue;
+			for (auto closure = m_nfa.closureBegin(move->second); closure != m_nfa.closureEnd(move->second); ++closure) {
+				if (m_seen[*closure] != m_generation) {
+					m_seen[*closure] = m_generation;
+					next_states.push_back(*closure);
+				}
+			}
+		}
+	}
+
+	if (next_states.empty()) {
+		m_next[(size_t)state * m_nfa.columnCount + column] = kDead;
+		return kDead;
+	}
+
+	std::sort(next_states.begin(), next_states.end());
+	if (m_state_mapping.find(next_states) == m_state_mapping.end() && m_subsets.size() >= m_max_states) {
+		// cache is full: start over, the caller only needs the id of the new state
+		Flush();
+		return AddState(next_states);
+	}
+
+	int next = AddState(next_states);
+	m_next[(size_t)state * m_nfa.columnCount + column] = next;
+	return next;
+}
+
+bool LazyDeterministicFiniteAutomaton::CheckWord(const std::string& word)
+{
+	return CheckWord(word.data(), word.size());
+}
+
+bool LazyDeterministicFiniteAutomaton::CheckWord(const char* word, size_t length)
+{
+	size_t columns = m_nfa.columnCount;
+	int current_state = m_start;
+	for (size_t i = 0; i < length; i++) {
+		int column = m_nfa.columns[(unsigned char)word[i]];
+		if (column < 0)
+			return false;
+
+		int next = m_next[(size_t)current_state * columns + column];
+		if (next == kUnknown)
+			next = ComputeTransition(current_state, column);
+		if (next == kDead)
+			return false;
+		current_state = next;
+	}
+
+	return m_accepting[current_state];
+}
+
+size_t LazyDeterministicFiniteAutomaton::getCachedStates() const
+{
+	return m_subsets.size();
+}
+
+size_t LazyDeterministicFiniteAutomaton::getFlushes() const
+{
+	return m_flushes;
+}
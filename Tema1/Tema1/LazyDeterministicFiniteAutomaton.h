@@ -0,0 +1,42 @@
+#pragma once
+
+#include<string>
+#include<unordered_map>
+#include<vector>
+
+#include "IndexedNfa.h"
+
+// Subset construction performed on demand: a DFA state and its outgoing
+// transitions are only computed the first time the input reaches them.
+class LazyDeterministicFiniteAutomaton
+{
+public:
+	LazyDeterministicFiniteAutomaton(const NondeterministicFiniteAutomaton& AFN, size_t max_states = 4096);
+	LazyDeterministicFiniteAutomaton(const IndexedNfa& indexed, size_t max_states = 4096);
+	~LazyDeterministicFiniteAutomaton() = default;
+
+	bool CheckWord(const std::string& word);
+	bool CheckWord(const char* word, size_t length);
+
+	size_t getCachedStates() const;
+	size_t getFlushes() const;
+
+private:
+	static constexpr int kUnknown = -2;
+	static constexpr int kDead = -1;
+
+	int AddState(const std::vector<int>& subset);
+	int ComputeTransition(int state, int column);
+	void Flush();
+
+	IndexedNfa m_nfa;
+	std::vector<std::vector<int>> m_subsets;
+	std::unordered_map<std::vector<int>, int, SubsetHash> m_state_mapping;
+	std::vector<int> m_next; // cached states x alphabet, kUnknown until computed
+	std::vector<unsigned char> m_accepting;
+	std::vector<int> m_seen;
+	int m_generation;
+	int m_start;
+	size_t m_max_states;
+	size_t m_flushes;
+};
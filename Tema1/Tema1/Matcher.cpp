@@ -0,0 +1,191 @@
+#include<algorithm>
+
+#include "Matcher.h"
+
+bool parseMatchEngine(const std::string& name, MatchEngine& engine)
+{
+	if (name == "dfa")
+		engine = MatchEngine::Dfa;
+	else if (name == "lazy")
+		engine = MatchEngine::LazyDfa;
+	else if (name == "nfa")
+		engine = MatchEngine::BitParallelNfa;
+	else if (name == "counting")
+		engine = MatchEngine::CountingNfa;
+	else
+		return false;
+	return true;
+}
+
+Matcher::Matcher(const std::string& regex, MatchEngine engine, const CompileBudget& budget)
+	: m_engine(engine), m_budget(budget)
+{
+	if (m_engine == MatchEngine::CountingNfa) {
+		// built from the AST, so its repetitions are never copied out into an NFA
+		BudgetMeter meter(budget);
+		m_counting = std::make_unique<CountingNfa>();
+		m_regex_valid = m_counting->Compile(regex, &meter) || meter.isExceeded();
+		m_budget_error = meter.getError();
+		return;
+	}
+
+	m_context.setBudget(budget);
+	if (m_context.CompileNfa(regex, m_graph)) {
+		m_has_graph = true;
+		m_nfa = IndexedNfa(m_graph);
+		Compile(m_context.getMeter());
+	}
+	// the parser is the only thing that fails a compilation within budget
+	m_regex_valid = m_has_graph || m_context.getBudgetError().limit != BudgetLimit::None;
+	m_budget_error = m_context.getBudgetError();
+	if (m_engine == MatchEngine::Dfa && m_budget_error.limit != BudgetLimit::None && budget.fallback)
+		CompileFallback(budget, &regex);
+}
+
+Matcher::Matcher(const NondeterministicFiniteAutomaton& AFN, MatchEngine engine, const CompileBudget& budget)
+	: m_engine(engine), m_budget(budget)
+{
+	// every engine indexes the whole NFA, closures included
+	BudgetMeter meter(budget);
+	if (meter.NfaStates(AFN.getStates().size())) {
+		m_nfa = IndexedNfa(AFN);
+		Compile(meter);
+	}
+	m_budget_error = meter.getError();
+	if (m_engine == MatchEngine::Dfa && m_budget_error.limit != BudgetLimit::None && budget.fallback)
+		CompileFallback(budget, nullptr);
+}
+
+void Matcher::Compile(BudgetMeter& meter)
+{
+	switch (m_engine)
+	{
+	case MatchEngine::Dfa:
+		CompileDfa(meter);
+		break;
+	case MatchEngine::LazyDfa:
+		// the cache is flushed rather than grown past the DFA state limit
+		if (meter.Deadline())
+			m_lazy = std::make_unique<LazyDeterministicFiniteAutomaton>(m_nfa,
+				m_budget.maxDfaStates != 0 ? std::min<size_t>(m_budget.maxDfaStates, 4096) : 4096);
+		break;
+	case MatchEngine::BitParallelNfa:
+	case MatchEngine::CountingNfa: { // only from an NFA, which has nothing left to count
+		m_engine = MatchEngine::BitParallelNfa;
+		auto simulation = std::make_unique<BitParallelNfa>(m_nfa, &meter);
+		if (!meter.isExceeded())
+			m_bit_parallel = std::move(simulation);
+		break;
+	}
+	}
+}
+
+bool Matcher::CompileDfa(BudgetMeter& meter)
+{
+	DeterministicFiniteAutomaton DFA = DeterministicFiniteAutomaton().AFNtoAFD(m_nfa, true, &meter);
+	if (meter.isExceeded())
+		return false;
+	m_dfa = std::make_unique<DeterministicFiniteAutomaton>(std::move(DFA));
+	m_compiled = CompiledDfa::Freeze(*m_dfa);
+	return true;
+}
+
+void Matcher::CompileFallback(const CompileBudget& budget, const std::string* regex)
+{
+	// the simulation is held to the same NFA state, memory and time limits, counted from here
+	CompileBudget limits = budget;
+	limits.maxDfaStates = 0;
+
+	// a counted repetition costs a bitset instead of a copy of its operand; with
+	// nothing to count, the counting NFA is only worth it when the NFA was not built
+	if (regex) {
+		BudgetMeter meter(limits);
+		auto counting = std::make_unique<CountingNfa>();
+		if (counting->Compile(*regex, &meter) && (counting->getCounterBits() != 0 || m_nfa.stateCount == 0)) {
+			m_engine = MatchEngine::CountingNfa;
+			m_counting = std::move(counting);
+			return;
+		}
+	}
+	if (m_nfa.stateCount == 0)
+		return;
+
+	m_engine = MatchEngine::BitParallelNfa;
+	BudgetMeter meter(limits);
+	size_t indexed_bytes = (m_nfa.closures.size() + m_nfa.closureOffset.size() + m_nfa.moveOffset.size()) * sizeof(int)
+		+ m_nfa.moves.size() * sizeof(m_nfa.moves[0]);
+	if (!meter.Bytes(indexed_bytes) || !meter.Deadline())
+		return;
+
+	auto simulation = std::make_unique<BitParallelNfa>(m_nfa, &meter);
+	if (!meter.isExceeded())
+		m_bit_parallel = std::move(simulation);
+}
+
+bool Matcher::CheckWord(const std::string& word)
+{
+	switch (m_engine)
+	{
+	case MatchEngine::LazyDfa:
+		return m_lazy && m_lazy->CheckWord(word);
+	case MatchEngine::BitParallelNfa:
+		return m_bit_parallel && m_bit_parallel->CheckWord(word, m_scratch);
+	case MatchEngine::CountingNfa:
+		return m_counting && m_counting->CheckWord(word, m_counting_scratch);
+	default:
+		return m_compiled && m_compiled->CheckWord(word);
+	}
+}
+
+MatchEngine Matcher::getEngine() const
+{
+	return m_engine;
+}
+
+DeterministicFiniteAutomaton& Matcher::getDfa()
+{
+	// only the Dfa engine builds it up front; the others determinize on request (e.g. for printing)
+	if (m_dfa)
+		return *m_dfa;
+	if (m_nfa.stateCount == 0 || m_budget_error.limit != BudgetLimit::None) {
+		m_dfa = std::make_unique<DeterministicFiniteAutomaton>();
+		return *m_dfa;
+	}
+
+	BudgetMeter meter(m_budget);
+	m_dfa = std::make_unique<DeterministicFiniteAutomaton>(DeterministicFiniteAutomaton().AFNtoAFD(m_nfa, true, &meter));
+	if (meter.isExceeded())
+		m_budget_error = meter.getError();
+	return *m_dfa;
+}
+
+const CompiledDfa* Matcher::getCompiledDfa() const
+{
+	return m_compiled ? &*m_compiled : nullptr;
+}
+
+const NfaGraph* Matcher::getNfaGraph() const
+{
+	return m_has_graph ? &m_graph : nullptr;
+}
+
+bool Matcher::isRegexValid() const
+{
+	return m_regex_valid;
+}
+
+const RegexParser& Matcher::getParser() const
+{
+	// the counting engine parses the regex itself
+	return m_counting ? m_counting->getParser() : m_context.getParser();
+}
+
+bool Matcher::isReady() const
+{
+	return m_compiled || m_lazy || m_bit_parallel || (m_counting && m_counting->getPositionCount() != 0);
+}
+
+const BudgetError& Matcher::getBudgetError() const
+{
+	return m_budget_error;
+}
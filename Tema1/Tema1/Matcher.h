@@ -0,0 +1,75 @@
+#pragma once
+
+#include<memory>
+#include<optional>
+#include<string>
+
+#include "CompileBudget.h"
+#include "CompiledDfa.h"
+#include "CompilerContext.h"
+#include "DeterministicFiniteAutomaton.h"
+#include "LazyDeterministicFiniteAutomaton.h"
+#include "BitParallelNfa.h"
+#include "CountingNfa.h"
+
+enum class MatchEngine
+{
+	Dfa, // subset construction up front, dense table walk
+	LazyDfa, // subset construction on demand
+	BitParallelNfa, // NFA simulation, no determinization
+	CountingNfa // NFA simulation with repetitions of single bytes counted, not copied out
+};
+
+bool parseMatchEngine(const std::string& name, MatchEngine& engine);
+
+// Compiles a pattern's NFA for the engine chosen for that pattern. Over
+// budget, nothing is compiled and every word is rejected, except that a Dfa
+// may fall back to an NFA simulation when the budget allows it: CountingNfa
+// for a regex with counted repetitions, or when its copied-out NFA was itself
+// over budget; BitParallelNfa otherwise. The fallback must itself fit the
+// budget's NFA state, memory and time limits. From a regex, the NFA is built
+// straight into its indexed form and the budget starts with the parse, so a
+// pattern over the NFA state limit is refused before it is built.
+// CountingNfa needs the regex: from an NFA, whose repetitions are already
+// copied out, it is simulated by BitParallelNfa.
+class Matcher
+{
+public:
+	Matcher(const std::string& regex, MatchEngine engine, const CompileBudget& budget = CompileBudget());
+	Matcher(const NondeterministicFiniteAutomaton& AFN, MatchEngine engine, const CompileBudget& budget = CompileBudget());
+	~Matcher() = default;
+
+	bool CheckWord(const std::string& word);
+	MatchEngine getEngine() const; // the engine actually used, after any fallback
+	// built within the budget when first asked for, counted from then; empty when the
+	// NFA was not built or the budget was already exceeded, or is exceeded on the way
+	DeterministicFiniteAutomaton& getDfa();
+	const CompiledDfa* getCompiledDfa() const; // null unless the Dfa engine froze its DFA
+	const NfaGraph* getNfaGraph() const; // null unless the NFA was built from a regex (never by CountingNfa)
+
+	bool isRegexValid() const; // false when the parser rejected the regex, see getParser
+	const RegexParser& getParser() const;
+	bool isReady() const; // false when the budget stopped the compilation
+	const BudgetError& getBudgetError() const; // set even when the engine fell back
+
+private:
+	void Compile(BudgetMeter& meter);
+	bool CompileDfa(BudgetMeter& meter);
+	void CompileFallback(const CompileBudget& budget, const std::string* regex);
+
+	CompilerContext m_context;
+	bool m_regex_valid = true;
+	NfaGraph m_graph;
+	bool m_has_graph = false;
+	IndexedNfa m_nfa; // no states when it was not built
+	MatchEngine m_engine;
+	CompileBudget m_budget;
+	BudgetError m_budget_error;
+	std::unique_ptr<DeterministicFiniteAutomaton> m_dfa;
+	std::optional<CompiledDfa> m_compiled; // what the Dfa engine matches with
+	std::unique_ptr<LazyDeterministicFiniteAutomaton> m_lazy;
+	std::unique_ptr<BitParallelNfa> m_bit_parallel;
+	BitParallelNfa::Scratch m_scratch;
+	std::unique_ptr<CountingNfa> m_counting;
+	CountingNfa::Scratch m_counting_scratch;
+};
@@ -0,0 +1,353 @@
+#include<algorithm>
+
+#include "NfaBuilder.h"
+
+void NfaBuilder::Clear()
+{
+	m_alias.clear();
+	m_edges.clear();
+	m_stack.clear();
+	m_classes.clear();
+}
+
+int NfaBuilder::AddState()
+{
+	m_alias.push_back((int)m_alias.size());
+	return (int)m_alias.size() - 1;
+}
+
+void NfaBuilder::AddEdge(int from, int symbol, int to)
+{
+	m_edges.push_back({ from, symbol, to });
+}
+
+int NfaBuilder::Resolve(int state) const
+{
+	while (m_alias[state] != state)
+		state = m_alias[state];
+	return state;
+}
+
+NfaBuilder::Fragment NfaBuilder::Symbol(int symbol)
+{
+	Fragment result = { AddState(), AddState() };
+	AddEdge(result.start, symbol, result.end);
+	return result;
+}
+
+NfaBuilder::Fragment NfaBuilder::Class(const ByteSet& bytes)
+{
+	// one edge for the whole set, split into byte columns only by IndexedNfa
+	Fragment result = { AddState(), AddState() };
+	AddEdge(result.start, NfaGraph::kClass + (int)m_classes.size(), result.end);
+	m_classes.push_back(bytes);
+	return result;
+}
+
+NfaBuilder::Fragment NfaBuilder::Concatenate(Fragment a, Fragment b)
+{
+	// a Thompson end state has no outgoing edges and a start state no incoming ones
+	m_alias[b.start] = a.end;
+	return { a.start, b.end };
+}
+
+NfaBuilder::Fragment NfaBuilder::Alternate(Fragment a, Fragment b)
+{
+	Fragment result = { AddState(), AddState() };
+	AddEdge(result.start, NfaGraph::kLambda, a.start);
+	AddEdge(a.end, NfaGraph::kLambda, result.end);
+	AddEdge(result.start, NfaGraph::kLambda, b.start);
+	AddEdge(b.end, NfaGraph::kLambda, result.end);
+	return result;
+}
+
+NfaBuilder::Fragment NfaBuilder::KleeneStar(Fragment a)
+{
+	Fragment result = { AddState(), AddState() };
+	AddEdge(result.start, NfaGraph::kLambda, a.start);
+	AddEdge(a.end, NfaGraph::kLambda, result.end);
+	AddEdge(result.start, NfaGraph::kLambda, result.end);
+	AddEdge(a.end, NfaGraph::kLambda, a.start);
+	return result;
+}
+
+NfaBuilder::Fragment NfaBuilder::Plus(Fragment a)
+{
+	Fragment result = { AddState(), AddState() };
+	AddEdge(result.start, NfaGraph::kLambda, a.start);
+	AddEdge(a.end, NfaGraph::kLambda, result.end);
+	AddEdge(a.end, NfaGraph::kLambda, a.start);
+	return result;
+}
+
+NfaBuilder::Fragment NfaBuilder::Empty()
+{
+	Fragment result = { AddState(), AddState() };
+	AddEdge(result.start, NfaGraph::kLambda, result.end);
+	return result;
+}
+
+NfaBuilder::Fragment NfaBuilder::Copy(Fragment a, const Span& span)
+{
+	// a subtree only merges and links states of its own span
+	int shift = (int)m_alias.size() - span.stateBegin;
+	for (int state = span.stateBegin; state < span.stateEnd; state++)
+		m_alias.push_back(m_alias[state] + shift);
+	for (int i = span.edgeBegin; i < span.edgeEnd; i++)
+	{
+		Edge edge = m_edges[i];
+		AddEdge(edge.from + shift, edge.symbol, edge.to + shift);
+	}
+	return { a.start + shift, a.end + shift };
+}
+
+NfaBuilder::Fragment NfaBuilder::Repeat(Fragment a, const Span& span, const RegexRepeat& repeat)
+{
+	bool unbounded = repeat.max == RegexRepeat::kUnbounded;
+	int count = unbounded ? std::max(repeat.min, 1) : repeat.max;
+	if (count == 0)
+		return Empty();
+	if (unbounded && repeat.min == 0)
+		return KleeneStar(a);
+
+	// every copy is taken before any of them is wired, while the operand is untouched
+	std::vector<Fragment> copies = { a };
+	for (int i = 1; i < count; i++)
+		copies.push_back(Copy(a, span));
+
+	if (unbounded)
+	{
+		copies.back() = Plus(copies.back());
+		Fragment result = copies[0];
+		for (int i = 1; i < count; i++)
+			result = Concatenate(result, copies[i]);
+		return result;
+	}
+
+	Fragment result = copies[0];
+	if (repeat.min == 0)
+	{
+		int start = AddState();
+		result = { start, start };
+	}
+	for (int i = 1; i < repeat.min; i++)
+		result = Concatenate(result, copies[i]);
+
+	int end = AddState();
+	for (int i = repeat.min; i < count; i++)
+	{
+		AddEdge(result.end, NfaGraph::kLambda, end);
+		result = Concatenate(result, copies[i]);
+	}
+	AddEdge(result.end, NfaGraph::kLambda, end);
+	return { result.start, end };
+}
+
+void NfaBuilder::Finish(Fragment fragment, NfaGraph& graph)
+{
+	// drop merged states and renumber the rest densely, in creation order
+	std::vector<int> number(m_alias.size(), -1);
+	int state_count = 0;
+	for (int state = 0; state < (int)m_alias.size(); state++)
+		if (m_alias[state] == state)
+			number[state] = state_count++;
+
+	graph.stateCount = state_count;
+	graph.start = number[Resolve(fragment.start)];
+	graph.accepting.assign(state_count, 0);
+	graph.accepting[number[Resolve(fragment.end)]] = 1;
+
+	graph.edgeOffset.assign(state_count + 1, 0);
+	for (const Edge& edge : m_edges)
+		graph.edgeOffset[number[Resolve(edge.from)] + 1]++;
+	for (int state = 0; state < state_count; state++)
+		graph.edgeOffset[state + 1] += graph.edgeOffset[state];
+
+	graph.edges.resize(m_edges.size());
+	std::vector<int> fill(graph.edgeOffset.begin(), graph.edgeOffset.end() - 1);
+	for (const Edge& edge : m_edges)
+		graph.edges[fill[number[Resolve(edge.from)]]++] = { edge.symbol, number[Resolve(edge.to)] };
+	graph.classes = m_classes;
+}
+
+bool NfaBuilder::BuildFromPolishForm(const std::vector<char>& polishForm, NfaGraph& graph)
+{
+	Clear();
+	m_alias.reserve(polishForm.size() * 2);
+	m_edges.reserve(polishForm.size() * 2);
+
+	const char* end = polishForm.data() + polishForm.size();
+	for (const char* it = polishForm.data(); it < end; it++)
+	{
+		char token = *it;
+		if (token == '[')
+		{
+			const char* class_end = findClassEnd(it, end);
+			ByteSet bytes;
+			if (class_end == end || !parseClass(it, class_end, bytes))
+				return false;
+			m_stack.push_back(Class(bytes));
+			it = class_end;
+		}
+		else if (token == '.' || token == '|')
+		{
+			if (m_stack.size() < 2)
+				return false;
+			Fragment b = m_stack.back();
+			m_stack.pop_back();
+			Fragment a = m_stack.back();
+			m_stack.pop_back();
+			m_stack.push_back(token == '.' ? Concatenate(a, b) : Alternate(a, b));
+		}
+		else if (token == '*')
+		{
+			if (m_stack.empty())
+				return false;
+			m_stack.back() = KleeneStar(m_stack.back());
+		}
+		else
+		{
+			m_stack.push_back(Symbol((unsigned char)token));
+		}
+	}
+
+	if (m_stack.size() != 1)
+		return false;
+
+	Finish(m_stack.back(), graph);
+	return true;
+}
+
+bool NfaBuilder::BuildFromAst(const RegexAst& ast, NfaGraph& graph)
+{
+	Clear();
+	if (ast.nodes.empty())
+		return false;
+	m_alias.reserve(ast.nodes.size() * 2);
+	m_edges.reserve(ast.nodes.size() * 2);
+
+	// operands come before their node, so their fragments are always ready
+	std::vector<Fragment>& fragments = m_stack;
+	fragments.resize(ast.nodes.size());
+	std::vector<Span> spans(ast.nodes.size());
+	for (size_t i = 0; i < ast.nodes.size(); i++)
+	{
+		const RegexNode& node = ast.nodes[i];
+		bool leaf = node.kind == RegexNode::Kind::Symbol || node.kind == RegexNode::Kind::Class;
+		spans[i].stateBegin = leaf ? (int)m_alias.size() : spans[node.left].stateBegin;
+		spans[i].edgeBegin = leaf ? (int)m_edges.size() : spans[node.left].edgeBegin;
+		switch (node.kind)
+		{
+		case RegexNode::Kind::Symbol:
+			fragments[i] = Symbol(node.left);
+			break;
+		case RegexNode::Kind::Class:
+			fragments[i] = Class(ast.classes[node.left]);
+			break;
+		case RegexNode::Kind::Concatenation:
+			fragments[i] = Concatenate(fragments[node.left], fragments[node.right]);
+			break;
+		case RegexNode::Kind::Alternation:
+			fragments[i] = Alternate(fragments[node.left], fragments[node.right]);
+			break;
+		case RegexNode::Kind::Star:
+			fragments[i] = KleeneStar(fragments[node.left]);
+			break;
+		case RegexNode::Kind::Repeat:
+			fragments[i] = Repeat(fragments[node.left], spans[node.left], ast.repeats[node.right]);
+			break;
+		}
+		spans[i].stateEnd = (int)m_alias.size();
+		spans[i].edgeEnd = (int)m_edges.size();
+	}
+
+	Finish(fragments[ast.root()], graph);
+	return true;
+}
+
+NondeterministicFiniteAutomaton NfaBuilder::ToAutomaton(const NfaGraph& graph)
+{
+	NondeterministicFiniteAutomaton result;
+	std::set<int> states;
+	std::set<char> alphabet;
+	std::unordered_map<std::pair<int, char>, std::vector<int>, NondeterministicFiniteAutomaton::PairHash> transitions;
+
+	for (int state = 0; state < graph.stateCount; state++)
+	{
+		states.insert(state);
+		for (int i = graph.edgeOffset[state]; i < graph.edgeOffset[state + 1]; i++)
+		{
+			const NfaEdge& edge = graph.edges[i];
+			auto add = [&](char symbol) {
+				alphabet.insert(symbol);
+				transitions[{ state, symbol }].push_back(edge.to);
+			};
+
+			if (edge.symbol == NfaGraph::kLambda)
+				add(NondeterministicFiniteAutomaton::kLambda);
+			else if (edge.symbol < NfaGraph::kClass)
+				add((char)edge.symbol);
+			else
+			{
+				// one transition per byte; the byte used for lambda cannot be represented
+				const ByteSet& bytes = graph.classes[edge.symbol - NfaGraph::kClass];
+				for (int symbol = 0; symbol < 256; symbol++)
+					if (bytes[symbol] && (char)symbol != NondeterministicFiniteAutomaton::kLambda)
+						add((char)symbol);
+			}
+		}
+	}
+
+	// a single final state: when there are several (e.g. Glushkov), they all get a lambda edge to a new one
+	int final_state = -1;
+	for (int state = 0; state < graph.stateCount; state++)
+		if (graph.accepting[state])
+			final_state = final_state == -1 ? state : graph.stateCount;
+	if (final_state == graph.stateCount)
+	{
+		states.insert(final_state);
+		alphabet.insert(NondeterministicFiniteAutomaton::kLambda);
+		for (int state = 0; state < graph.stateCount; state++)
+			if (graph.accepting[state])
+				transitions[{ state, NondeterministicFiniteAutomaton::kLambda }].push_back(final_state);
+	}
+
+	result.setStates(std::move(states));
+	result.setAlphabet(std::move(alphabet));
+	result.setTransitions(std::move(transitions));
+	result.setInitState(graph.start);
+	result.setFinalState(final_state);
+	return result;
+}
+
+NfaGraph NfaBuilder::FromAutomaton(const NondeterministicFiniteAutomaton& AFN)
+{
+	// states renumbered densely, in the order of the states set
+	std::unordered_map<int, int> index;
+	for (int state : AFN.getStates())
+		index.emplace(state, (int)index.size());
+	index.emplace(AFN.getInitState(), (int)index.size());
+	index.emplace(AFN.getFinalState(), (int)index.size());
+
+	NfaGraph graph;
+	graph.stateCount = (int)index.size();
+	graph.start = index[AFN.getInitState()];
+	graph.accepting.assign(graph.stateCount, 0);
+	graph.accepting[index[AFN.getFinalState()]] = 1;
+
+	std::vector<std::vector<NfaEdge>> edges(graph.stateCount);
+	for (const auto& [rule, destinations] : AFN.getTransitions())
+		for (int destination : destinations)
+		{
+			int symbol = rule.second == NondeterministicFiniteAutomaton::kLambda ? NfaGraph::kLambda : (unsigned char)rule.second;
+			edges[index[rule.first]].push_back({ symbol, index[destination] });
+		}
+
+	graph.edgeOffset.assign(graph.stateCount + 1, 0);
+	for (int state = 0; state < graph.stateCount; state++)
+	{
+		graph.edges.insert(graph.edges.end(), edges[state].begin(), edges[state].end());
+		graph.edgeOffset[state + 1] = (int)graph.edges.size();
+	}
+	return graph;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include<vector>
+
+#include "NfaGraph.h"
+#include "NondeterministicFiniteAutomaton.h"
+#include "Regex.h"
+#include "RegexParser.h"
+
+// Thompson construction into a single arena: every operator only touches the
+// start/end states of its operand fragments, so building is linear in the
+// length of the polish form or the number of AST nodes. Concatenation merges the end of the left operand
+// with the start of the right one, like NondeterministicFiniteAutomaton::Concatenate.
+// A repetition copies its operand's states and edges out of the arena, once
+// per copy; the optional copies of {m,n} all skip to one shared end state.
+class NfaBuilder
+{
+public:
+	struct Fragment
+	{
+		int start;
+		int end;
+	};
+
+	// the states and edges a fragment was built from: those of its AST subtree
+	struct Span
+	{
+		int stateBegin;
+		int stateEnd;
+		int edgeBegin;
+		int edgeEnd;
+	};
+
+	NfaBuilder() = default;
+	~NfaBuilder() = default;
+
+	bool BuildFromPolishForm(const std::vector<char>& polishForm, NfaGraph& graph);
+	bool BuildFromAst(const RegexAst& ast, NfaGraph& graph);
+	static NondeterministicFiniteAutomaton ToAutomaton(const NfaGraph& graph);
+	static NfaGraph FromAutomaton(const NondeterministicFiniteAutomaton& AFN);
+
+	Fragment Symbol(int symbol);
+	Fragment Class(const ByteSet& bytes);
+	Fragment Concatenate(Fragment a, Fragment b);
+	Fragment Alternate(Fragment a, Fragment b);
+	Fragment KleeneStar(Fragment a);
+	Fragment Plus(Fragment a);
+	Fragment Empty();
+	Fragment Copy(Fragment a, const Span& span);
+	Fragment Repeat(Fragment a, const Span& span, const RegexRepeat& repeat);
+
+	void Clear();
+	void Finish(Fragment fragment, NfaGraph& graph);
+
+private:
+	struct Edge
+	{
+		int from;
+		int symbol;
+		int to;
+	};
+
+	int AddState();
+	void AddEdge(int from, int symbol, int to);
+	int Resolve(int state) const;
+
+	std::vector<int> m_alias; // merged states point at the state that replaced them
+	std::vector<Edge> m_edges;
+	std::vector<Fragment> m_stack;
+	std::vector<ByteSet> m_classes;
+};
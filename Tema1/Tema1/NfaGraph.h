@@ -0,0 +1,25 @@
+#pragma once
+
+#include<bitset>
+#include<vector>
+
+struct NfaEdge
+{
+	int symbol; // byte value, kLambda, or kClass + index in NfaGraph::classes
+	int to;
+};
+
+// Contiguous NFA: states 0..stateCount-1, outgoing edges of state s are
+// edges[edgeOffset[s] .. edgeOffset[s + 1]).
+struct NfaGraph
+{
+	static constexpr int kLambda = -1;
+	static constexpr int kClass = 256;
+
+	int stateCount = 0;
+	int start = 0;
+	std::vector<unsigned char> accepting;
+	std::vector<int> edgeOffset;
+	std::vector<NfaEdge> edges;
+	std::vector<std::bitset<256>> classes; // byte sets of the class edges
+};
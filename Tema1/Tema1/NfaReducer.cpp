@@ -0,0 +1,197 @@
+#include<algorithm>
+#include<map>
+
+#include "NfaReducer.h"
+
+NfaReduction NfaReducer::Reduce(NfaGraph& graph)
+{
+	NfaReduction report;
+	report.statesBefore = graph.stateCount;
+	report.edgesBefore = graph.edges.size();
+	for (const NfaEdge& edge : graph.edges)
+		report.lambdaEdgesBefore += edge.symbol == NfaGraph::kLambda;
+
+	EliminateLambda(graph);
+	Trim(graph.start);
+	report.mergedStates = Merge();
+	Store(graph.start, graph);
+
+	report.statesAfter = graph.stateCount;
+	report.edgesAfter = graph.edges.size();
+	return report;
+}
+
+void NfaReducer::EliminateLambda(const NfaGraph& graph)
+{
+	int state_count = graph.stateCount;
+	m_edges.assign(state_count, {});
+	m_accepting.assign(graph.accepting.begin(), graph.accepting.end());
+
+	// only the start and the targets of symbol edges stay reachable, the
+	// closures of the other states are never needed
+	std::vector<unsigned char> entered(state_count, 0);
+	entered[graph.start] = 1;
+	for (const NfaEdge& edge : graph.edges)
+		if (edge.symbol != NfaGraph::kLambda)
+			entered[edge.to] = 1;
+
+	std::vector<int> seen(state_count, -1);
+	std::vector<int> stack;
+	for (int state = 0; state < state_count; state++) {
+		if (!entered[state])
+			continue;
+		std::vector<Edge>& edges = m_edges[state];
+		stack.push_back(state);
+		seen[state] = state;
+		while (!stack.empty()) {
+			int current = stack.back();
+			stack.pop_back();
+			m_accepting[state] |= graph.accepting[current];
+			for (int i = graph.edgeOffset[current]; i < graph.edgeOffset[current + 1]; i++) {
+				const NfaEdge& edge = graph.edges[i];
+				if (edge.symbol != NfaGraph::kLambda)
+					edges.push_back({ edge.symbol, edge.to });
+				else if (seen[edge.to] != state) {
+					seen[edge.to] = state;
+					stack.push_back(edge.to);
+				}
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+	}
+}
+
+void NfaReducer::Trim(int start)
+{
+	int state_count = (int)m_edges.size();
+	std::vector<unsigned char> reachable(state_count, 0);
+	std::vector<int> stack = { start };
+	reachable[start] = 1;
+	while (!stack.empty()) {
+		int state = stack.back();
+		stack.pop_back();
+		for (const Edge& edge : m_edges[state])
+			if (!reachable[edge.to]) {
+				reachable[edge.to] = 1;
+				stack.push_back(edge.to);
+			}
+	}
+
+	// walk the reachable part backwards from the accepting states
+	std::vector<std::vector<int>> predecessors(state_count);
+	for (int state = 0; state < state_count; state++)
+		if (reachable[state])
+			for (const Edge& edge : m_edges[state])
+				predecessors[edge.to].push_back(state);
+
+	std::vector<unsigned char> useful(state_count, 0);
+	for (int state = 0; state < state_count; state++)
+		if (reachable[state] && m_accepting[state]) {
+			useful[state] = 1;
+			stack.push_back(state);
+		}
+	while (!stack.empty()) {
+		int state = stack.back();
+		stack.pop_back();
+		for (int predecessor : predecessors[state])
+			if (!useful[predecessor]) {
+				useful[predecessor] = 1;
+				stack.push_back(predecessor);
+			}
+	}
+
+	// the start state stays even when the language is empty
+	useful[start] = 1;
+	m_number.assign(state_count, -1);
+	int kept = 0;
+	for (int state = 0; state < state_count; state++)
+		if (useful[state])
+			m_number[state] = kept++;
+	for (int state = 0; state < state_count; state++) {
+		if (!useful[state]) {
+			std::vector<Edge>().swap(m_edges[state]);
+			continue;
+		}
+		auto dropped = [this](const Edge& edge) { return m_number[edge.to] == -1; };
+		m_edges[state].erase(std::remove_if(m_edges[state].begin(), m_edges[state].end(), dropped), m_edges[state].end());
+	}
+}
+
+size_t NfaReducer::Merge()
+{
+	// block of every kept state; two states share one when they accept alike and
+	// have the same edges into the same blocks
+	int state_count = (int)m_edges.size();
+	std::vector<int> kept;
+	for (int state = 0; state < state_count; state++)
+		if (m_number[state] != -1)
+			kept.push_back(state);
+
+	std::vector<int> block = m_number;
+	std::vector<int> next_block(state_count, -1);
+	size_t blocks = kept.size();
+	std::map<std::vector<int>, int> signatures;
+	std::vector<std::pair<int, int>> targets;
+	std::vector<int> signature;
+	for (int round = 0; round < kMaxMergeRounds; round++) {
+		signatures.clear();
+		for (int state : kept) {
+			targets.clear();
+			for (const Edge& edge : m_edges[state])
+				targets.push_back({ edge.symbol, block[edge.to] });
+			std::sort(targets.begin(), targets.end());
+			targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+
+			signature.assign(1, m_accepting[state]);
+			for (auto [symbol, target] : targets) {
+				signature.push_back(symbol);
+				signature.push_back(target);
+			}
+			next_block[state] = signatures.emplace(signature, (int)signatures.size()).first->second;
+		}
+		block.swap(next_block);
+		bool stable = signatures.size() == blocks;
+		blocks = signatures.size();
+		if (stable)
+			break;
+	}
+
+	m_number.swap(block);
+	return kept.size() - blocks;
+}
+
+void NfaReducer::Store(int start, NfaGraph& graph)
+{
+	// the reduced states in order of their first member
+	int state_count = (int)m_edges.size();
+	std::vector<int> renumber(state_count, -1);
+	std::vector<int> representative;
+	for (int state = 0; state < state_count; state++) {
+		int block = m_number[state];
+		if (block != -1 && renumber[block] == -1) {
+			renumber[block] = (int)representative.size();
+			representative.push_back(state);
+		}
+	}
+
+	int reduced = (int)representative.size();
+	graph.stateCount = reduced;
+	graph.start = renumber[m_number[start]];
+	graph.accepting.assign(reduced, 0);
+	graph.edgeOffset.assign(reduced + 1, 0);
+	graph.edges.clear();
+	std::vector<Edge> edges;
+	for (int state = 0; state < reduced; state++) {
+		int member = representative[state];
+		graph.accepting[state] = m_accepting[member];
+		edges.clear();
+		for (const Edge& edge : m_edges[member])
+			edges.push_back({ edge.symbol, renumber[m_number[edge.to]] });
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+		for (const Edge& edge : edges)
+			graph.edges.push_back({ edge.symbol, edge.to });
+		graph.edgeOffset[state + 1] = (int)graph.edges.size();
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include<cstddef>
+#include<vector>
+
+#include "NfaGraph.h"
+
+struct NfaReduction
+{
+	size_t statesBefore = 0;
+	size_t statesAfter = 0;
+	size_t edgesBefore = 0;
+	size_t edgesAfter = 0;
+	size_t lambdaEdgesBefore = 0; // none are left after
+	size_t mergedStates = 0;
+};
+
+// Shrinks an NFA before subset construction, in three steps:
+// - lambda elimination: every state takes over the symbol edges and the
+//   acceptance of its lambda-closure, so forwarding states lose all their
+//   incoming edges;
+// - trimming: states not reachable from the start, or from which no accepting
+//   state can be reached, are dropped;
+// - merging: states with the same acceptance and the same edges (into states
+//   already merged) are one state, repeated until nothing changes.
+// The language is unchanged; subsets get smaller and no closure is left to do.
+class NfaReducer
+{
+public:
+	NfaReducer() = default;
+	~NfaReducer() = default;
+
+	NfaReduction Reduce(NfaGraph& graph);
+
+private:
+	static constexpr int kMaxMergeRounds = 64;
+
+	struct Edge
+	{
+		int symbol;
+		int to;
+		bool operator<(const Edge& other) const { return symbol != other.symbol ? symbol < other.symbol : to < other.to; }
+		bool operator==(const Edge& other) const { return symbol == other.symbol && to == other.to; }
+	};
+
+	void EliminateLambda(const NfaGraph& graph);
+	void Trim(int start);
+	size_t Merge();
+	void Store(int start, NfaGraph& graph);
+
+	std::vector<std::vector<Edge>> m_edges; // symbol edges per state after lambda elimination
+	std::vector<unsigned char> m_accepting;
+	std::vector<int> m_number; // state -> its block, -1 when dropped
+};
@@ -1,25 +1,40 @@
 ﻿#include "NondeterministicFiniteAutomaton.h"
+#include "NfaBuilder.h"
+#include "CompilerContext.h"
 
 typedef NondeterministicFiniteAutomaton nfa;
 
-int NondeterministicFiniteAutomaton::m_stateCounter = 0;
-
 std::set<int>& NondeterministicFiniteAutomaton::getStates()
 {
     return m_states;
 }
 
+const std::set<int>& NondeterministicFiniteAutomaton::getStates() const
+{
+    return m_states;
+}
+
 std::set<char>& NondeterministicFiniteAutomaton::getAlphabet()
 {
     return m_alphabet;
 }
 
+const std::set<char>& NondeterministicFiniteAutomaton::getAlphabet() const
+{
+    return m_alphabet;
+}
+
 std::unordered_map<std::pair<int, char>, std::vector<int>, NondeterministicFiniteAutomaton::PairHash>& NondeterministicFiniteAutomaton::getTransitions()
 {
     return m_transitions;
 }
 
-int NondeterministicFiniteAutomaton::getFinalState()
+const std::unordered_map<std::pair<int, char>, std::vector<int>, NondeterministicFiniteAutomaton::PairHash>& NondeterministicFiniteAutomaton::getTransitions() const
+{
+    return m_transitions;
+}
+
+int NondeterministicFiniteAutomaton::getFinalState() const
 {
     return m_final_state;
 }
@@ -85,43 +100,30 @@ void NondeterministicFiniteAutomaton::copyTransitions(const nfa& a)
 
 nfa NondeterministicFiniteAutomaton::returnAFNfromPolishForm(std::vector<char> polishForm)
 {
-    std::stack<nfa> automatonStack;
-    for (auto i = 0; i < polishForm.size(); i++)
-    {
-        nfa result;
-        if (polishForm[i] == '.')
-        {
-            nfa a = automatonStack.top();
-            automatonStack.pop();
-            nfa b = automatonStack.top();
-            automatonStack.pop();
-            result = Concatenate(a, b);
-        }
-        else if(polishForm[i] == '|')
-        {
-            nfa a = automatonStack.top();
-            automatonStack.pop();
-            nfa b = automatonStack.top();
-            automatonStack.pop();
-            result = Alternate(a, b);
-        }
-        else if (polishForm[i] == '*')
-        {
-            result = KleeneStar(automatonStack.top());
-            automatonStack.pop();
-        }
-        else
-        {
-            result.m_init_state = m_stateCounter;
-            m_stateCounter++;
-            result.m_final_state = m_stateCounter;
-            m_stateCounter++;
-            result.addTransition(result.m_init_state, polishForm[i], result.m_final_state);
-        }
-        automatonStack.push(result);
-    }
+    NfaBuilder builder;
+    NfaGraph graph;
+    if (!builder.BuildFromPolishForm(polishForm, graph))
+        return nfa();
+
+    return NfaBuilder::ToAutomaton(graph);
+}
+
+nfa NondeterministicFiniteAutomaton::Reduce(NfaReduction& report) const
+{
+    NfaGraph graph = NfaBuilder::FromAutomaton(*this);
+    report = NfaReducer().Reduce(graph);
+    return NfaBuilder::ToAutomaton(graph);
+}
+
+nfa NondeterministicFiniteAutomaton::returnGlushkovAFN(const std::string& regex)
+{
+    CompilerContext context;
+    context.setConstruction(NfaConstruction::Glushkov);
+    NfaGraph graph;
+    if (!context.CompileNfa(regex, graph))
+        return nfa();
 
-    return automatonStack.top();
+    return NfaBuilder::ToAutomaton(graph);
 }
 
 void NondeterministicFiniteAutomaton::PrintAutomation(std::ostream& os)
@@ -132,14 +134,14 @@ void NondeterministicFiniteAutomaton::PrintAutomation(std::ostream& os)
 
     os <<std::endl<< "\nAlphabet:\n";
     for (char symbol : m_alphabet)
-        os << symbol << ", ";
+        os << (symbol == kLambda ? 'L' : symbol) << ", ";
 
     os << "\n\nTransitions:\n";
     for (const auto& transition : m_transitions)
     {
         for (int destination : transition.second)
         {
-            os << transition.first.first << " --" << transition.first.second << "--> " << destination << "; ";
+            os << transition.first.first << " --" << (transition.first.second == kLambda ? 'L' : transition.first.second) << "--> " << destination << "; ";
         }
         os << std::endl;
     }
@@ -180,34 +182,30 @@ nfa NondeterministicFiniteAutomaton::Concatenate(nfa b, nfa a)
     return result;
 }
 
-nfa NondeterministicFiniteAutomaton::Alternate(nfa b, nfa a)
+nfa NondeterministicFiniteAutomaton::Alternate(nfa b, nfa a, CompilerContext& context)
 {
     nfa result;
-    result.m_init_state = m_stateCounter;
-    m_stateCounter++;
-    result.m_final_state= m_stateCounter;
-    m_stateCounter++;
+    result.m_init_state = context.NewState();
+    result.m_final_state = context.NewState();
     result.copyTransitions(a);
     result.copyTransitions(b);
-    result.addTransition(result.m_init_state, 'L', a.m_init_state);
-    result.addTransition(a.m_final_state, 'L', result.m_final_state);
-    result.addTransition(result.m_init_state, 'L', b.m_init_state);
-    result.addTransition(b.m_final_state, 'L', result.m_final_state);
+    result.addTransition(result.m_init_state, kLambda, a.m_init_state);
+    result.addTransition(a.m_final_state, kLambda, result.m_final_state);
+    result.addTransition(result.m_init_state, kLambda, b.m_init_state);
+    result.addTransition(b.m_final_state, kLambda, result.m_final_state);
     return result;
 }
 
-nfa NondeterministicFiniteAutomaton::KleeneStar(nfa a)
+nfa NondeterministicFiniteAutomaton::KleeneStar(nfa a, CompilerContext& context)
 {
     nfa result;
-    result.m_init_state = m_stateCounter;
-    m_stateCounter++;
-    result.m_final_state = m_stateCounter;
-    m_stateCounter++;
+    result.m_init_state = context.NewState();
+    result.m_final_state = context.NewState();
     result.copyTransitions(a);
-    result.addTransition(result.m_init_state, 'L', a.m_init_state);
-    result.addTransition(a.m_final_state, 'L', result.m_final_state);
-    result.addTransition(result.m_init_state, 'L', result.m_final_state);
-    result.addTransition(a.m_final_state, 'L', a.m_init_state);
+    result.addTransition(result.m_init_state, kLambda, a.m_init_state);
+    result.addTransition(a.m_final_state, kLambda, result.m_final_state);
+    result.addTransition(result.m_init_state, kLambda, result.m_final_state);
+    result.addTransition(a.m_final_state, kLambda, a.m_init_state);
     return result;
 }
 
@@ -5,14 +5,22 @@
 #include<tuple>
 #include<unordered_map>
 #include<map>
+#include<vector>
 #include<string>
 #include<stack>
 #include<iostream>
 
+#include "NfaReducer.h"
+
+class CompilerContext;
+
 class NondeterministicFiniteAutomaton
 {
 	typedef NondeterministicFiniteAutomaton nfa;
-private:
+public:
+	// symbol of lambda transitions, printed as 'L'; a NUL byte keeps every letter usable
+	static constexpr char kLambda = '\0';
+
 	struct PairHash {
 		template <typename T1, typename T2>
 		std::size_t operator()(const std::pair<T1, T2>& p) const {
@@ -22,14 +30,16 @@ private:
 		}
 	};
 
-public:
 	NondeterministicFiniteAutomaton() = default;
 	~NondeterministicFiniteAutomaton() = default;
 
 	std::set<int>& getStates();
+	const std::set<int>& getStates() const;
 	std::set<char>& getAlphabet();
+	const std::set<char>& getAlphabet() const;
 	std::unordered_map<std::pair<int, char>, std::vector<int>, PairHash>& getTransitions();
-	int getFinalState();
+	const std::unordered_map<std::pair<int, char>, std::vector<int>, PairHash>& getTransitions() const;
+	int getFinalState() const;
 	int getInitState() const;
 
 	void setStates(std::set<int> states);
@@ -41,13 +51,14 @@ public:
 	void addTransition(int initalState, char symbol, int finalState);
 	void copyTransitions(const nfa& a);
 	nfa returnAFNfromPolishForm(std::vector<char> polishForm);
+	nfa returnGlushkovAFN(const std::string& regex);
+	nfa Reduce(NfaReduction& report) const; // see NfaReducer
 	void PrintAutomation(std::ostream& os);
 
 	nfa Concatenate(nfa b, nfa a);
-	nfa Alternate(nfa b, nfa a);
-	nfa KleeneStar(nfa a);
+	nfa Alternate(nfa b, nfa a, CompilerContext& context);
+	nfa KleeneStar(nfa a, CompilerContext& context);
 
-	static int m_stateCounter;
 private:
 	std::set<int> m_states; //Q
 	std::set<char> m_alphabet; //Σ
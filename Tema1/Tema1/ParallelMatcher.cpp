@@ -0,0 +1,136 @@
+#include<algorithm>
+#include<thread>
+
+#include "ParallelMatcher.h"
+
+ParallelMatcher::ParallelMatcher(TransitionTableView table, unsigned threads, size_t min_chunk)
+	: m_table(table), m_threads(threads), m_min_chunk(std::max<size_t>(min_chunk, 1))
+{
+	if (m_threads == 0)
+		m_threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool ParallelMatcher::CheckWord(const std::string& word) const
+{
+	return CheckWord(word.data(), word.size());
+}
+
+bool ParallelMatcher::CheckWord(const char* word, size_t length) const
+{
+	size_t chunk_count = std::min<size_t>(m_threads, length / m_min_chunk);
+	if (chunk_count <= 1)
+		return m_table.CheckWord(word, length);
+
+	std::vector<Chunk> chunks(chunk_count);
+	size_t slice = length / chunk_count;
+	for (size_t i = 0; i < chunk_count; i++) {
+		chunks[i].begin = word + i * slice;
+		chunks[i].length = i + 1 == chunk_count ? length - i * slice : slice;
+	}
+
+	bool enumerate = m_table.dead <= kMaxEnumerated;
+	int first_state = m_table.start;
+	auto worker = [&](size_t index) {
+		if (index == 0)
+			first_state = Run(m_table.start, chunks[0].begin, chunks[0].length);
+		else if (enumerate)
+			Enumerate(chunks[index]);
+		else
+			Speculate(chunks[index]);
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < chunk_count; i++)
+		threads.emplace_back(worker, i);
+	worker(0);
+	for (auto& thread : threads)
+		thread.join();
+
+	int state = first_state;
+	for (size_t i = 1; i < chunk_count && state != m_table.dead; i++)
+		state = enumerate ? chunks[i].mapping[state] : Resolve(chunks[i], state);
+	return m_table.accepting[state];
+}
+
+int ParallelMatcher::Run(int state, const char* begin, size_t length) const
+{
+	for (size_t i = 0; i < length && state != m_table.dead; i++)
+		state = m_table.step(state, (unsigned char)begin[i]);
+	return state;
+}
+
+void ParallelMatcher::Enumerate(Chunk& chunk) const
+{
+	// one walk per distinct current state; lane_of[s] is the walk start state s follows, -1 once dead
+	int state_count = m_table.dead;
+	std::vector<int> lanes(state_count);
+	std::vector<int> lane_of(state_count);
+	for (int state = 0; state < state_count; state++)
+		lanes[state] = lane_of[state] = state;
+
+	std::vector<int> owner(state_count, -1);
+	std::vector<int> moved;
+	for (size_t i = 0; i < chunk.length && !lanes.empty(); i += kMergeInterval) {
+		size_t end = std::min(chunk.length, i + kMergeInterval);
+		for (size_t j = i; j < end; j++) {
+			int column = m_table.columns[(unsigned char)chunk.begin[j]];
+			for (int& lane : lanes)
+				lane = m_table.next[lane * m_table.columnCount + column];
+		}
+
+		// merge walks that reached the same state, drop the dead ones
+		moved.assign(lanes.size(), -1);
+		size_t kept = 0;
+		for (size_t lane = 0; lane < lanes.size(); lane++) {
+			int state = lanes[lane];
+			if (state == m_table.dead)
+				continue;
+			if (owner[state] == -1) {
+				owner[state] = (int)kept;
+				lanes[kept++] = state;
+			}
+			moved[lane] = owner[state];
+		}
+		lanes.resize(kept);
+		for (int state : lanes)
+			owner[state] = -1;
+		for (int& lane : lane_of)
+			if (lane != -1)
+				lane = moved[lane];
+	}
+
+	chunk.mapping.assign(state_count + 1, m_table.dead);
+	for (int state = 0; state < state_count; state++)
+		if (lane_of[state] != -1)
+			chunk.mapping[state] = lanes[lane_of[state]];
+}
+
+void ParallelMatcher::Speculate(Chunk& chunk) const
+{
+	// the walk over the bytes just before the chunk has usually forgotten where it started
+	size_t lookback = std::min(kLookback, m_min_chunk);
+	int guess = Run(m_table.start, chunk.begin - lookback, lookback);
+	chunk.guess = guess == m_table.dead ? m_table.start : guess;
+
+	int state = chunk.guess;
+	for (size_t i = 0; i < chunk.length; i += kCheckpoint) {
+		state = Run(state, chunk.begin + i, std::min(kCheckpoint, chunk.length - i));
+		chunk.checkpoints.push_back(state);
+	}
+}
+
+int ParallelMatcher::Resolve(const Chunk& chunk, int state) const
+{
+	if (state == chunk.guess)
+		return chunk.checkpoints.back();
+
+	// wrong guess: walk again until both walks agree on a checkpoint
+	for (size_t i = 0, checkpoint = 0; i < chunk.length; i += kCheckpoint, checkpoint++) {
+		state = Run(state, chunk.begin + i, std::min(kCheckpoint, chunk.length - i));
+		if (state == chunk.checkpoints[checkpoint])
+			return chunk.checkpoints.back();
+		if (state == m_table.dead)
+			return state;
+	}
+	return state;
+}
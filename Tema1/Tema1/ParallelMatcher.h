@@ -0,0 +1,51 @@
+#pragma once
+
+#include<cstddef>
+#include<string>
+#include<vector>
+
+#include "TransitionTable.h"
+
+// Matches one very large word on several cores. The word is cut into one
+// chunk per thread; the first chunk runs from the start state, every other
+// one from states nobody knows yet:
+// - small DFAs run the chunk from every state at once and record the
+//   state -> state mapping; walks that meet in the same state merge, so after
+//   a few bytes usually only a handful are left.
+// - larger ones guess the incoming state from the bytes just before the chunk
+//   and, if the guess is wrong, redo the chunk until the walk meets the
+//   speculative one at a checkpoint.
+// The chunks are then chained in order from the start state.
+class ParallelMatcher
+{
+public:
+	ParallelMatcher(TransitionTableView table, unsigned threads = 0, size_t min_chunk = 1 << 20);
+	~ParallelMatcher() = default;
+
+	bool CheckWord(const std::string& word) const;
+	bool CheckWord(const char* word, size_t length) const;
+
+private:
+	static constexpr int kMaxEnumerated = 64; // more states than this are speculated
+	static constexpr size_t kMergeInterval = 256;
+	static constexpr size_t kLookback = 1024;
+	static constexpr size_t kCheckpoint = 4096;
+
+	struct Chunk
+	{
+		const char* begin;
+		size_t length;
+		std::vector<int> mapping; // enumerated: state at the end for every start state
+		int guess = 0; // speculated: the start state assumed
+		std::vector<int> checkpoints; // speculated: state every kCheckpoint bytes, then the final one
+	};
+
+	int Run(int state, const char* begin, size_t length) const;
+	void Enumerate(Chunk& chunk) const;
+	void Speculate(Chunk& chunk) const;
+	int Resolve(const Chunk& chunk, int state) const;
+
+	TransitionTableView m_table;
+	unsigned m_threads;
+	size_t m_min_chunk;
+};
@@ -0,0 +1,135 @@
+#include<bit>
+#include<cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include<emmintrin.h>
+#define PREFILTER_SSE2
+#endif
+
+#include "Prefilter.h"
+
+void Prefilter::Clear()
+{
+	m_prefix.clear();
+	m_leading.clear();
+	m_is_leading.fill(false);
+}
+
+void Prefilter::Build(const TransitionTable& table)
+{
+	Clear();
+	// a pattern that accepts the empty word matches everywhere
+	if (table.empty() || table.accepting[table.start])
+		return;
+
+	for (int symbol = 0; symbol < 256; symbol++)
+		if (table.step(table.start, (unsigned char)symbol) != table.dead) {
+			m_leading.push_back((unsigned char)symbol);
+			m_is_leading[symbol] = true;
+		}
+	if (m_leading.size() == 256)
+		m_leading.clear();
+
+	int state = table.start;
+	while (!table.accepting[state] && m_prefix.size() < kMaxPrefix) {
+		int next = table.dead;
+		int symbols = 0;
+		unsigned char only = 0;
+		for (int symbol = 0; symbol < 256 && symbols < 2; symbol++) {
+			int target = table.step(state, (unsigned char)symbol);
+			if (target != table.dead) {
+				next = target;
+				only = (unsigned char)symbol;
+				symbols++;
+			}
+		}
+		if (symbols != 1)
+			break;
+		m_prefix += (char)only;
+		state = next;
+	}
+}
+
+bool Prefilter::isEnabled() const
+{
+	return !m_leading.empty();
+}
+
+const std::string& Prefilter::getPrefix() const
+{
+	return m_prefix;
+}
+
+size_t Prefilter::getLeadingByteCount() const
+{
+	return m_leading.size();
+}
+
+size_t Prefilter::Find(const char* text, size_t from, size_t length) const
+{
+	if (from >= length)
+		return length;
+	if (m_prefix.size() >= 2)
+		return FindPrefix(text, from, length);
+	return FindLeadingByte(text, from, length);
+}
+
+size_t Prefilter::FindPrefix(const char* text, size_t from, size_t length) const
+{
+	size_t last = m_prefix.size() - 1;
+	size_t i = from;
+#ifdef PREFILTER_SSE2
+	// compare the first and the last byte of the literal at once, memcmp only the blocks where both agree
+	const __m128i first = _mm_set1_epi8(m_prefix[0]);
+	const __m128i final = _mm_set1_epi8(m_prefix[last]);
+	for (; i + last + 16 <= length; i += 16) {
+		__m128i head = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i*)(text + i)));
+		__m128i tail = _mm_cmpeq_epi8(final, _mm_loadu_si128((const __m128i*)(text + i + last)));
+		unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(head, tail));
+		while (mask) {
+			size_t offset = i + std::countr_zero(mask);
+			if (std::memcmp(text + offset + 1, m_prefix.data() + 1, last - 1) == 0)
+				return offset;
+			mask &= mask - 1;
+		}
+	}
+#endif
+	while (i + last < length) {
+		const void* found = std::memchr(text + i, m_prefix[0], length - last - i);
+		if (!found)
+			break;
+		i = (const char*)found - text;
+		if (std::memcmp(text + i + 1, m_prefix.data() + 1, last) == 0)
+			return i;
+		i++;
+	}
+	return length;
+}
+
+size_t Prefilter::FindLeadingByte(const char* text, size_t from, size_t length) const
+{
+	if (m_leading.size() == 1) {
+		const void* found = std::memchr(text + from, m_leading[0], length - from);
+		return found ? (const char*)found - text : length;
+	}
+
+	size_t i = from;
+#ifdef PREFILTER_SSE2
+	if (m_leading.size() <= 3) {
+		const __m128i a = _mm_set1_epi8((char)m_leading[0]);
+		const __m128i b = _mm_set1_epi8((char)m_leading[1]);
+		const __m128i c = _mm_set1_epi8((char)m_leading.back());
+		for (; i + 16 <= length; i += 16) {
+			__m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+			__m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, a), _mm_cmpeq_epi8(block, b)), _mm_cmpeq_epi8(block, c));
+			unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+			if (mask)
+				return i + std::countr_zero(mask);
+		}
+	}
+#endif
+	for (; i < length; i++)
+		if (m_is_leading[(unsigned char)text[i]])
+			return i;
+	return length;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include<array>
+#include<string>
+#include<vector>
+
+#include "TransitionTable.h"
+
+// Bytes a match has to start with, read off an anchored DFA: the literal
+// every match begins with (the path from the start state until it branches
+// or accepts) and the set of bytes leaving the start state. Find skips to the
+// next offset where a match can begin, 16 bytes at a time with SSE2.
+class Prefilter
+{
+public:
+	Prefilter() = default;
+	~Prefilter() = default;
+
+	void Build(const TransitionTable& table);
+	void Clear();
+
+	bool isEnabled() const;
+	const std::string& getPrefix() const;
+	size_t getLeadingByteCount() const;
+
+	// first candidate offset in [from, length), or length when there is none
+	size_t Find(const char* text, size_t from, size_t length) const;
+
+private:
+	static constexpr size_t kMaxPrefix = 32;
+
+	size_t FindPrefix(const char* text, size_t from, size_t length) const;
+	size_t FindLeadingByte(const char* text, size_t from, size_t length) const;
+
+	std::string m_prefix;
+	std::vector<unsigned char> m_leading;
+	std::array<bool, 256> m_is_leading{};
+};
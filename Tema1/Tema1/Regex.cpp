@@ -0,0 +1,246 @@
+﻿#include<fstream>
+#include<stack>
+#include<cstring>
+#include<cctype>
+
+#include "Regex.h"
+
+void readRegex(std::string file_name, std::string& regex)
+{
+    std::ifstream f(file_name);
+    f >> regex;
+    f.close();
+}
+
+static const std::string kAnyByte = "[^\n]";
+
+static bool isOperator(char c)
+{
+    return c != 0 && strchr("()|*", c) != 0;
+}
+
+const char* findClassEnd(const char* begin, const char* end)
+{
+    const char* it = begin + 1;
+    if (it < end && *it == '^')
+        it++;
+    if (it < end && *it == ']')
+        it++;
+    while (it < end && *it != ']')
+        it++;
+    return it;
+}
+
+bool parseClass(const char* begin, const char* class_end, ByteSet& bytes)
+{
+    bytes.reset();
+    const char* it = begin + 1;
+    bool negated = it < class_end && *it == '^';
+    if (negated)
+        it++;
+
+    for (; it < class_end; it++)
+    {
+        unsigned char low = *it;
+        if (it + 2 < class_end && it[1] == '-')
+        {
+            unsigned char high = it[2];
+            if (high < low)
+                return false;
+            for (int symbol = low; symbol <= high; symbol++)
+                bytes.set(symbol);
+            it += 2;
+        }
+        else
+            bytes.set(low);
+    }
+
+    if (negated)
+        bytes.flip();
+    return bytes.any();
+}
+
+void formatRegex(std::string& regex)
+{
+    // an explicit '.' goes between an operand end (symbol, class, ')' or '*')
+    // and an operand start (symbol, class or '('); the wildcard becomes a class
+    std::string regex_aux;
+    bool operand_end = false;
+    const char* end = regex.data() + regex.size();
+    for (const char* it = regex.data(); it < end; it++)
+    {
+        bool operand_start = *it == '(' || !isOperator(*it);
+        if (operand_end && operand_start)
+            regex_aux += '.';
+
+        if (*it == '[')
+        {
+            const char* class_end = findClassEnd(it, end);
+            regex_aux.append(it, class_end < end ? class_end + 1 : end);
+            it = class_end;
+        }
+        else if (*it == '.')
+            regex_aux += kAnyByte;
+        else
+            regex_aux += *it;
+
+        operand_end = *it == ')' || *it == '*' || !isOperator(*it);
+    }
+    regex = regex_aux;
+}
+
+bool verifyParenthesis(const std::string& regex)
+{
+    std::stack<char> parenthesis;
+
+    for (int i = 0; regex[i]; ++i)
+    {
+        if (regex[i] == '(')
+            parenthesis.emplace(regex[i]);
+        else if (regex[i] == ')')
+        {
+            if (parenthesis.empty())
+                return false;
+
+            parenthesis.pop();
+        }
+    }
+
+    if (parenthesis.empty())
+        return true;
+    return false;
+}
+
+bool verifyOperators(const std::string& regex)
+{
+    if (regex[0] == '|' || regex[regex.size() - 1] == '|' || regex[0] == '*')
+    {
+        return false;
+    }
+
+    for (int i = 1; i < regex.size() - 1; ++i)
+    {
+        if (regex[i] == '|' && (strchr("()|*", regex[i - 1]) || strchr("()|*", regex[i + 1])))
+            return false;
+        else if (regex[i] == '*' && (regex[i - 1] == '(' || regex[i - 1] == '*'))
+            return false;
+    }
+
+    return true;
+}
+
+bool isValidRegex(const std::string& regex)
+{
+    // classes must be well formed; the operator checks then see each one as a symbol
+    std::string skeleton;
+    const char* end = regex.data() + regex.size();
+    for (const char* it = regex.data(); it < end; it++)
+    {
+        if (*it == '[')
+        {
+            const char* class_end = findClassEnd(it, end);
+            ByteSet bytes;
+            if (class_end == end || parseClass(it, class_end, bytes) == false)
+                return false;
+            it = class_end;
+            skeleton += 'a';
+        }
+        else if (*it == ']')
+            return false;
+        else if (*it == '.')
+            skeleton += 'a';
+        else
+            skeleton += *it;
+    }
+
+    return skeleton.empty() == false && verifyParenthesis(skeleton) && verifyOperators(skeleton);
+}
+
+int priority(char c)
+{
+
+    switch (c)
+    {
+    case '(':
+        return 0;
+
+    case ')':
+        return 0;
+
+    case '|':
+        return 1;
+
+    case '.':
+        return 2;
+
+    case '*':
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+std::vector<char> regexToPolishForm(std::string pattern)
+{
+    std::vector<char> polish;
+    regexToPolishForm(pattern, polish);
+    return polish;
+}
+
+void regexToPolishForm(const std::string& pattern, std::vector<char>& polish)
+{
+    polish.clear();
+    std::stack<char> op_stack;
+
+    for (int i = 0; pattern[i]; ++i)
+    {
+        if (pattern[i] == '[')
+        {
+            // a class is one operand, copied whole
+            const char* end = pattern.data() + pattern.size();
+            const char* class_end = findClassEnd(pattern.data() + i, end);
+            if (class_end == end)
+                break;
+            polish.insert(polish.end(), pattern.data() + i, class_end + 1);
+            i = (int)(class_end - pattern.data());
+        }
+        else if (isalnum((unsigned char)pattern[i]))
+        {
+            polish.push_back(pattern[i]);
+        }
+        else
+        {
+            if (pattern[i] == '(')
+                op_stack.push(pattern[i]);
+            else
+            {
+                if (pattern[i] == ')')
+                {
+                    while (!op_stack.empty() && op_stack.top() != '(')
+                    {
+                        polish.push_back(op_stack.top());
+                        op_stack.pop();
+                    }
+                    if (!op_stack.empty())
+                        op_stack.pop(); //scoate paranteza
+                }
+                else
+                {
+                    //daca expression[i] e operator
+                    while (!op_stack.empty() && priority(op_stack.top()) >= priority(pattern[i]))
+                    {
+                        polish.push_back(op_stack.top());
+                        op_stack.pop();
+                    }
+                    op_stack.push(pattern[i]);
+                }
+            }
+        }
+    }
+
+    while (!op_stack.empty())
+    {
+        polish.push_back(op_stack.top());
+        op_stack.pop();
+    }
+}
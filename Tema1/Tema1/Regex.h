@@ -0,0 +1,22 @@
+﻿#pragma once
+
+#include<bitset>
+#include<string>
+#include<vector>
+
+using ByteSet = std::bitset<256>;
+
+void readRegex(std::string file_name, std::string& regex);
+void formatRegex(std::string& regex);
+bool verifyParenthesis(const std::string& regex);
+bool verifyOperators(const std::string& regex);
+bool isValidRegex(const std::string& regex);
+int priority(char c);
+std::vector<char> regexToPolishForm(std::string pattern);
+void regexToPolishForm(const std::string& pattern, std::vector<char>& polish);
+
+// Character classes are single operands: [abc], [a-z0-9], [^...], and '.' for
+// any byte but '\n'. A ']' right after '[' or '[^' is a literal.
+// findClassEnd returns the ']' closing the class that opens at begin, or end.
+const char* findClassEnd(const char* begin, const char* end);
+bool parseClass(const char* begin, const char* class_end, ByteSet& bytes);
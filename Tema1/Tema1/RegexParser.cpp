@@ -0,0 +1,194 @@
+#include<algorithm>
+
+#include "RegexParser.h"
+
+bool RegexParser::Parse(std::string_view regex, RegexAst& ast)
+{
+	m_ast = &ast;
+	ast.clear();
+	ast.nodes.reserve(regex.size() * 2);
+	m_groups.assign(1, Group{ 0 });
+	m_error.clear();
+	m_error_offset = 0;
+
+	if (regex.empty())
+		return Fail(0, "empty regex");
+
+	bool after_quantifier = false;
+	const char* begin = regex.data();
+	const char* end = begin + regex.size();
+	for (const char* it = begin; it < end; it++) {
+		size_t offset = it - begin;
+		char token = *it;
+		if (token == '(')
+			m_groups.push_back(Group{ offset });
+		else if (token == ')') {
+			if (m_groups.size() == 1)
+				return Fail(offset, "')' without a matching '('");
+			Group& group = m_groups.back();
+			if (group.last == -1 && group.alternation == -1)
+				return Fail(offset, "empty group");
+			if (!CloseAlternative(group, offset))
+				return false;
+			int operand = group.alternation;
+			m_groups.pop_back();
+			AddOperand(m_groups.back(), operand);
+		}
+		else if (token == '|') {
+			if (!CloseAlternative(m_groups.back(), offset))
+				return false;
+		}
+		else if (token == '*' || token == '+' || token == '?' || token == '{') {
+			Group& group = m_groups.back();
+			if (group.last == -1)
+				return Fail(offset, "quantifier without an operand");
+			if (after_quantifier)
+				return Fail(offset, "two quantifiers in a row");
+			if (token == '*')
+				group.last = AddNode(RegexNode::Kind::Star, group.last);
+			else {
+				RegexRepeat repeat = { token == '+' ? 1 : 0, token == '?' ? 1 : RegexRepeat::kUnbounded };
+				if (token == '{' && !ParseCounts(it, end, offset, repeat))
+					return false;
+				ast.repeats.push_back(repeat);
+				group.last = AddNode(RegexNode::Kind::Repeat, group.last, (int)ast.repeats.size() - 1);
+			}
+		}
+		else if (token == '}')
+			return Fail(offset, "'}' without a matching '{'");
+		else if (token == '[') {
+			const char* class_end = findClassEnd(it, end);
+			if (class_end == end)
+				return Fail(offset, "'[' without a matching ']'");
+			ByteSet bytes;
+			if (!parseClass(it, class_end, bytes))
+				return Fail(offset, "empty class or reversed range");
+			ast.classes.push_back(bytes);
+			AddOperand(m_groups.back(), AddNode(RegexNode::Kind::Class, (int)ast.classes.size() - 1));
+			it = class_end;
+		}
+		else if (token == ']')
+			return Fail(offset, "']' without a matching '['");
+		else if (token == '.') {
+			ast.classes.push_back(ByteSet().set().reset('\n'));
+			AddOperand(m_groups.back(), AddNode(RegexNode::Kind::Class, (int)ast.classes.size() - 1));
+		}
+		else
+			AddOperand(m_groups.back(), AddNode(RegexNode::Kind::Symbol, (unsigned char)token));
+		after_quantifier = token == '*' || token == '+' || token == '?' || token == '{';
+	}
+
+	if (m_groups.size() > 1)
+		return Fail(m_groups.back().open, "'(' without a matching ')'");
+	if (!CloseAlternative(m_groups.back(), regex.size()))
+		return false;
+	if (!ast.repeats.empty() && ast.ExpandedSize(kMaxExpandedSize + 1) > kMaxExpandedSize)
+		return Fail(0, "repetitions make the regex too large");
+	return true;
+}
+
+size_t RegexAst::ExpandedSize(size_t limit, bool counted) const
+{
+	std::vector<size_t> size(nodes.size());
+	std::vector<bool> single(nodes.size(), false); // every word of the node is one byte
+	for (size_t i = 0; i < nodes.size(); i++) {
+		const RegexNode& node = nodes[i];
+		switch (node.kind) {
+		case RegexNode::Kind::Symbol:
+		case RegexNode::Kind::Class:
+			size[i] = 1;
+			single[i] = true;
+			break;
+		case RegexNode::Kind::Concatenation:
+		case RegexNode::Kind::Alternation:
+			size[i] = std::min(size[node.left] + size[node.right], limit);
+			single[i] = node.kind == RegexNode::Kind::Alternation && single[node.left] && single[node.right];
+			break;
+		case RegexNode::Kind::Star:
+			size[i] = size[node.left];
+			break;
+		case RegexNode::Kind::Repeat: {
+			const RegexRepeat& repeat = repeats[node.right];
+			size_t copies = repeat.max == RegexRepeat::kUnbounded ? std::max(repeat.min, 1) : repeat.max;
+			if (counted && single[node.left] && copies > 1)
+				size[i] = std::min(size[node.left] + 1, limit);
+			else
+				size[i] = copies != 0 && size[node.left] > limit / copies ? limit : std::min(size[node.left] * copies, limit);
+			break;
+		}
+		}
+	}
+	return nodes.empty() ? 0 : size.back();
+}
+
+size_t RegexParser::getErrorOffset() const
+{
+	return m_error_offset;
+}
+
+const std::string& RegexParser::getError() const
+{
+	return m_error;
+}
+
+bool RegexParser::Fail(size_t offset, const char* message)
+{
+	m_error_offset = offset;
+	m_error = message;
+	m_ast->clear();
+	return false;
+}
+
+int RegexParser::AddNode(RegexNode::Kind kind, int left, int right)
+{
+	m_ast->nodes.push_back({ kind, left, right });
+	return (int)m_ast->nodes.size() - 1;
+}
+
+void RegexParser::AddOperand(Group& group, int operand)
+{
+	// implicit concatenation: the previous operand can no longer take a '*'
+	if (group.last != -1)
+		group.prefix = group.prefix == -1 ? group.last : AddNode(RegexNode::Kind::Concatenation, group.prefix, group.last);
+	group.last = operand;
+}
+
+bool RegexParser::CloseAlternative(Group& group, size_t offset)
+{
+	if (group.last == -1)
+		return Fail(offset, "'|' without an operand on one side");
+
+	int alternative = group.prefix == -1 ? group.last : AddNode(RegexNode::Kind::Concatenation, group.prefix, group.last);
+	group.alternation = group.alternation == -1 ? alternative : AddNode(RegexNode::Kind::Alternation, group.alternation, alternative);
+	group.prefix = group.last = -1;
+	return true;
+}
+
+bool RegexParser::ParseCounts(const char*& it, const char* end, size_t offset, RegexRepeat& repeat)
+{
+	// {m}, {m,} or {m,n}; it is left on the closing '}'
+	auto number = [&it, end](int& value) {
+		const char* digits = it;
+		value = 0;
+		for (; it < end && *it >= '0' && *it <= '9'; it++)
+			value = std::min(value * 10 + (*it - '0'), kMaxRepeat + 1);
+		return it != digits;
+	};
+
+	it++;
+	if (!number(repeat.min))
+		return Fail(offset, "'{' without a count");
+	repeat.max = repeat.min;
+	if (it < end && *it == ',') {
+		it++;
+		if (!number(repeat.max))
+			repeat.max = RegexRepeat::kUnbounded;
+	}
+	if (it == end || *it != '}')
+		return Fail(offset, "'{' without a matching '}'");
+	if (repeat.min > kMaxRepeat || repeat.max > kMaxRepeat)
+		return Fail(offset, "repetition count above the limit");
+	if (repeat.max != RegexRepeat::kUnbounded && repeat.max < repeat.min)
+		return Fail(offset, "repetition with its minimum above its maximum");
+	return true;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include<string>
+#include<string_view>
+#include<vector>
+
+#include "Regex.h"
+
+struct RegexNode
+{
+	enum class Kind : unsigned char
+	{
+		Symbol, // left is the byte
+		Class, // left indexes RegexAst::classes
+		Concatenation,
+		Alternation,
+		Star, // left is the operand
+		Repeat // left is the operand, right indexes RegexAst::repeats
+	};
+
+	Kind kind;
+	int left;
+	int right = -1;
+};
+
+// '+', '?' and {m}, {m,}, {m,n}: between min and max copies of the operand
+struct RegexRepeat
+{
+	static constexpr int kUnbounded = -1;
+
+	int min;
+	int max; // kUnbounded for '+' and {m,}
+};
+
+// Every node comes after its operands, so a single forward loop over nodes
+// visits the tree in postorder; root is the last node.
+struct RegexAst
+{
+	std::vector<RegexNode> nodes;
+	std::vector<ByteSet> classes;
+	std::vector<RegexRepeat> repeats;
+
+	int root() const { return (int)nodes.size() - 1; }
+
+	// symbol and class occurrences once every repetition is copied out, saturated at limit;
+	// with counted, a repetition of a single-byte operand is one occurrence (see CountingNfa)
+	size_t ExpandedSize(size_t limit, bool counted = false) const;
+
+	void clear()
+	{
+		nodes.clear();
+		classes.clear();
+		repeats.clear();
+	}
+};
+
+// Validates a regex, inserts the implicit concatenations and builds its AST in
+// one left-to-right pass, replacing isValidRegex + formatRegex +
+// regexToPolishForm. Groups are kept on an explicit stack, so deeply nested
+// machine-generated patterns cannot overflow the call stack. Besides '*', the
+// quantifiers '+', '?', {m}, {m,} and {m,n} apply to the operand before them.
+// Any byte that is not an operator, '[', ']', '{', '}' or '.' is a literal.
+class RegexParser
+{
+public:
+	RegexParser() = default;
+	~RegexParser() = default;
+
+	bool Parse(std::string_view regex, RegexAst& ast);
+
+	// where the last Parse failed and why
+	size_t getErrorOffset() const;
+	const std::string& getError() const;
+
+	static constexpr int kMaxRepeat = 100000; // largest count in {m,n}
+	static constexpr size_t kMaxExpandedSize = 1 << 22; // symbol occurrences after copying out every repetition
+
+private:
+	struct Group
+	{
+		size_t open; // offset of its '(', unused for the outermost group
+		int alternation = -1; // alternatives before the current one, joined
+		int prefix = -1; // current alternative without its last operand
+		int last = -1; // last operand, the one a quantifier applies to
+	};
+
+	bool Fail(size_t offset, const char* message);
+	int AddNode(RegexNode::Kind kind, int left, int right = -1);
+	void AddOperand(Group& group, int operand);
+	bool CloseAlternative(Group& group, size_t offset);
+	bool ParseCounts(const char*& it, const char* end, size_t offset, RegexRepeat& repeat);
+
+	RegexAst* m_ast = nullptr;
+	std::vector<Group> m_groups;
+	size_t m_error_offset = 0;
+	std::string m_error;
+};
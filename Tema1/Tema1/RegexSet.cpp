@@ -0,0 +1,126 @@
+#include<algorithm>
+
+#include "RegexSet.h"
+#include "CompilerContext.h"
+
+bool RegexSet::Compile(const std::vector<std::string>& regexes)
+{
+	m_pattern_count = regexes.size();
+	m_invalid.clear();
+
+	// state 0 is the alternation root, each pattern's states follow at an offset
+	NfaGraph combined;
+	std::vector<NfaEdge> root_edges;
+	std::vector<int> pattern_of_state = { -1 };
+	combined.stateCount = 1;
+	combined.edgeOffset = { 0, 0 };
+
+	CompilerContext context;
+	NfaGraph graph;
+	for (int pattern = 0; pattern < (int)regexes.size(); pattern++) {
+		if (!context.CompileNfa(regexes[pattern], graph)) {
+			m_invalid.push_back(pattern);
+			continue;
+		}
+
+		int offset = combined.stateCount;
+		int class_offset = (int)combined.classes.size();
+		root_edges.push_back({ NfaGraph::kLambda, offset + graph.start });
+		for (int state = 0; state < graph.stateCount; state++) {
+			pattern_of_state.push_back(graph.accepting[state] ? pattern : -1);
+			for (int i = graph.edgeOffset[state]; i < graph.edgeOffset[state + 1]; i++) {
+				int symbol = graph.edges[i].symbol;
+				if (symbol >= NfaGraph::kClass)
+					symbol += class_offset;
+				combined.edges.push_back({ symbol, offset + graph.edges[i].to });
+			}
+			combined.edgeOffset.push_back((int)combined.edges.size());
+		}
+		combined.stateCount += graph.stateCount;
+		combined.classes.insert(combined.classes.end(), graph.classes.begin(), graph.classes.end());
+	}
+
+	combined.edges.insert(combined.edges.begin(), root_edges.begin(), root_edges.end());
+	for (size_t state = 1; state < combined.edgeOffset.size(); state++)
+		combined.edgeOffset[state] += (int)root_edges.size();
+	combined.start = 0;
+	combined.accepting.assign(combined.stateCount, 0);
+	for (int state = 0; state < combined.stateCount; state++)
+		combined.accepting[state] = pattern_of_state[state] != -1;
+
+	IndexedNfa indexed(combined);
+	std::vector<std::vector<int>> subsets;
+	std::vector<int> next;
+	indexed.Determinize(subsets, next);
+
+	int state_count = (int)subsets.size();
+	int columns = indexed.columnCount;
+	m_table.clear();
+	m_table.dead = state_count;
+	m_table.start = 0;
+	m_table.columnCount = columns + 1;
+	for (int symbol = 0; symbol < 256; symbol++)
+		m_table.columns[symbol] = indexed.columns[symbol] < 0 ? columns : indexed.columns[symbol];
+	m_table.next.assign((size_t)(state_count + 1) * m_table.columnCount, m_table.dead);
+	m_table.accepting.assign(state_count + 1, 0);
+
+	m_match_offset.assign(1, 0);
+	m_matches.clear();
+	for (int state = 0; state < state_count; state++) {
+		for (int column = 0; column < columns; column++) {
+			int target = next[(size_t)state * columns + column];
+			if (target != -1)
+				m_table.next[(size_t)state * m_table.columnCount + column] = target;
+		}
+
+		size_t begin = m_matches.size();
+		for (int nfa_state : subsets[state])
+			if (pattern_of_state[nfa_state] != -1)
+				m_matches.push_back(pattern_of_state[nfa_state]);
+		std::sort(m_matches.begin() + begin, m_matches.end());
+		m_matches.erase(std::unique(m_matches.begin() + begin, m_matches.end()), m_matches.end());
+		m_table.accepting[state] = m_matches.size() > begin;
+		m_match_offset.push_back((int)m_matches.size());
+	}
+	m_match_offset.push_back((int)m_matches.size()); // dead state matches nothing
+
+	return m_invalid.empty();
+}
+
+std::vector<int> RegexSet::Match(const std::string& word) const
+{
+	std::vector<int> patterns;
+	Match(word.data(), word.size(), patterns);
+	return patterns;
+}
+
+void RegexSet::Match(const char* word, size_t length, std::vector<int>& patterns) const
+{
+	patterns.clear();
+	if (m_table.empty())
+		return;
+
+	int current_state = m_table.start;
+	for (size_t i = 0; i < length; i++) {
+		current_state = m_table.step(current_state, (unsigned char)word[i]);
+		if (current_state == m_table.dead)
+			return;
+	}
+
+	patterns.assign(m_matches.begin() + m_match_offset[current_state], m_matches.begin() + m_match_offset[current_state + 1]);
+}
+
+size_t RegexSet::getPatternCount() const
+{
+	return m_pattern_count;
+}
+
+size_t RegexSet::getStateCount() const
+{
+	return m_table.empty() ? 0 : m_table.dead;
+}
+
+const std::vector<int>& RegexSet::getInvalidPatterns() const
+{
+	return m_invalid;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include<string>
+#include<vector>
+
+#include "IndexedNfa.h"
+#include "TransitionTable.h"
+
+// Several patterns compiled into one DFA: the Thompson NFAs hang off a common
+// alternation root and every DFA state remembers which patterns it accepts,
+// so one scan of a word reports all matching patterns.
+class RegexSet
+{
+public:
+	RegexSet() = default;
+	~RegexSet() = default;
+
+	bool Compile(const std::vector<std::string>& regexes);
+
+	std::vector<int> Match(const std::string& word) const;
+	void Match(const char* word, size_t length, std::vector<int>& patterns) const;
+
+	size_t getPatternCount() const;
+	size_t getStateCount() const;
+	const std::vector<int>& getInvalidPatterns() const;
+
+private:
+	TransitionTable m_table;
+	std::vector<int> m_match_offset; // per DFA state: range in m_matches
+	std::vector<int> m_matches; // sorted pattern ids
+	std::vector<int> m_invalid;
+	size_t m_pattern_count = 0;
+};
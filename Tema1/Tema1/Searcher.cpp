@@ -0,0 +1,237 @@
+#include "Searcher.h"
+#include "CompilerContext.h"
+
+namespace
+{
+	// Dense table of a subset construction; bytes outside the alphabet go to the
+	// dead state, or back to the initial subset when the automaton is unanchored.
+	void buildTable(const IndexedNfa& AFN, const std::vector<std::vector<int>>& subsets, const std::vector<int>& next,
+		bool unanchored, TransitionTable& table)
+	{
+		int state_count = (int)subsets.size();
+		int columns = AFN.columnCount;
+		table.clear();
+		table.dead = state_count;
+		table.start = 0;
+		table.columnCount = columns + 1;
+		for (int symbol = 0; symbol < 256; symbol++)
+			table.columns[symbol] = AFN.columns[symbol] < 0 ? columns : AFN.columns[symbol];
+		table.next.assign((size_t)(state_count + 1) * table.columnCount, table.dead);
+		table.accepting.assign(state_count + 1, 0);
+
+		for (int state = 0; state < state_count; state++) {
+			for (int column = 0; column < columns; column++) {
+				int target = next[(size_t)state * columns + column];
+				if (target != -1)
+					table.next[(size_t)state * table.columnCount + column] = target;
+			}
+			if (unanchored)
+				table.next[(size_t)state * table.columnCount + columns] = 0;
+
+			for (int nfa_state : subsets[state])
+				if (AFN.accepting[nfa_state]) {
+					table.accepting[state] = 1;
+					break;
+				}
+		}
+	}
+
+	// Same states with every edge turned around; the new start state (numbered
+	// after the others) has lambda edges to the old accepting states.
+	NfaGraph reverseGraph(const NfaGraph& graph)
+	{
+		NfaGraph reversed;
+		reversed.stateCount = graph.stateCount + 1;
+		reversed.start = graph.stateCount;
+		reversed.accepting.assign(reversed.stateCount, 0);
+		reversed.accepting[graph.start] = 1;
+		reversed.classes = graph.classes;
+
+		reversed.edgeOffset.assign(reversed.stateCount + 1, 0);
+		for (const NfaEdge& edge : graph.edges)
+			reversed.edgeOffset[edge.to + 1]++;
+		for (int state = 0; state < graph.stateCount; state++)
+			if (graph.accepting[state])
+				reversed.edgeOffset[reversed.start + 1]++;
+		for (int state = 0; state < reversed.stateCount; state++)
+			reversed.edgeOffset[state + 1] += reversed.edgeOffset[state];
+
+		reversed.edges.resize(reversed.edgeOffset.back());
+		std::vector<int> fill(reversed.edgeOffset.begin(), reversed.edgeOffset.end() - 1);
+		for (int state = 0; state < graph.stateCount; state++) {
+			for (int i = graph.edgeOffset[state]; i < graph.edgeOffset[state + 1]; i++)
+				reversed.edges[fill[graph.edges[i].to]++] = { graph.edges[i].symbol, state };
+			if (graph.accepting[state])
+				reversed.edges[fill[reversed.start]++] = { NfaGraph::kLambda, state };
+		}
+		return reversed;
+	}
+}
+
+bool Searcher::Compile(const std::string& regex, bool prefilter)
+{
+	m_forward.clear();
+	m_reverse.clear();
+	m_prefilter.Clear();
+	m_live.clear();
+	m_live_map.clear();
+
+	NfaGraph graph;
+	CompilerContext context;
+	if (!context.CompileNfa(regex, graph))
+		return false;
+
+	std::vector<int> next;
+	IndexedNfa forward(graph);
+	forward.Determinize(m_forward_subsets, next);
+	buildTable(forward, m_forward_subsets, next, false, m_forward);
+
+	IndexedNfa reverse(reverseGraph(graph));
+	reverse.Determinize(m_reverse_subsets, next, true);
+	buildTable(reverse, m_reverse_subsets, next, true, m_reverse);
+
+	size_t pairs = m_forward_subsets.size() * m_reverse_subsets.size();
+	if (pairs <= kMaxLivePairs)
+		m_live.assign(pairs, -1);
+
+	if (prefilter)
+		m_prefilter.Build(m_forward);
+	return true;
+}
+
+bool Searcher::Live(int forward, int reverse)
+{
+	// a forward state can still be extended into a match iff it shares an NFA
+	// state with the set that reaches acceptance from the current offset
+	long long key = (long long)forward * m_reverse_subsets.size() + reverse;
+	if (!m_live.empty() && m_live[key] != -1)
+		return m_live[key];
+	if (m_live.empty()) {
+		auto it = m_live_map.find(key);
+		if (it != m_live_map.end())
+			return it->second;
+	}
+
+	const std::vector<int>& a = m_forward_subsets[forward];
+	const std::vector<int>& b = m_reverse_subsets[reverse];
+	bool live = false;
+	for (size_t i = 0, j = 0; i < a.size() && j < b.size() && !live;) {
+		if (a[i] < b[j])
+			i++;
+		else if (b[j] < a[i])
+			j++;
+		else
+			live = true;
+	}
+
+	if (!m_live.empty())
+		m_live[key] = live;
+	else
+		m_live_map.emplace(key, live);
+	return live;
+}
+
+std::vector<SearchMatch> Searcher::FindAll(const std::string& text)
+{
+	std::vector<SearchMatch> matches;
+	FindAll(text.data(), text.size(), matches);
+	return matches;
+}
+
+void Searcher::FindAll(const char* text, size_t length, std::vector<SearchMatch>& matches)
+{
+	matches.clear();
+	if (m_forward.empty())
+		return;
+
+	size_t cursor = m_prefilter.isEnabled() ? FindCandidates(text, length, matches) : 0;
+	if (cursor <= length)
+		FindTwoPass(text + cursor, length - cursor, cursor, matches);
+}
+
+size_t Searcher::FindCandidates(const char* text, size_t length, std::vector<SearchMatch>& matches)
+{
+	// Verifying a candidate walks the anchored DFA until it dies, which can run far
+	// past the match. Once that work outgrows the text covered, hand the rest of the
+	// buffer to the linear two-pass search. The pattern is not nullable here, so
+	// every match is at least one byte long.
+	size_t verified = 0;
+	size_t cursor = 0;
+	while (cursor < length) {
+		if (verified > kVerifyFactor * cursor + kVerifySlack)
+			return cursor;
+
+		size_t begin = m_prefilter.Find(text, cursor, length);
+		if (begin == length)
+			break;
+
+		int state = m_forward.start;
+		size_t end = begin;
+		size_t i = begin;
+		while (i < length) {
+			state = m_forward.step(state, (unsigned char)text[i++]);
+			if (state == m_forward.dead)
+				break;
+			if (m_forward.accepting[state])
+				end = i;
+		}
+		verified += i - begin;
+
+		if (end > begin) {
+			matches.push_back({ begin, end });
+			cursor = end;
+		}
+		else
+			cursor = begin + 1;
+	}
+	return length + 1;
+}
+
+void Searcher::FindTwoPass(const char* text, size_t length, size_t offset, std::vector<SearchMatch>& matches)
+{
+	// backward: m_reverse_at[i] describes every match suffix of text[i..length)
+	m_reverse_at.resize(length + 1);
+	m_reverse_at[length] = m_reverse.start;
+	for (size_t i = length; i > 0; i--)
+		m_reverse_at[i - 1] = m_reverse.step(m_reverse_at[i], (unsigned char)text[i - 1]);
+
+	// forward: a match begins at i iff the pattern's start state is in that set
+	size_t cursor = 0;
+	while (cursor <= length) {
+		size_t begin = cursor;
+		while (begin <= length && !m_reverse.accepting[m_reverse_at[begin]])
+			begin++;
+		if (begin > length)
+			break;
+
+		int state = m_forward.start;
+		size_t end = begin;
+		for (size_t i = begin;;) {
+			if (m_forward.accepting[state])
+				end = i;
+			if (i == length)
+				break;
+			state = m_forward.step(state, (unsigned char)text[i++]);
+			if (state == m_forward.dead || !Live(state, m_reverse_at[i]))
+				break;
+		}
+
+		matches.push_back({ offset + begin, offset + end });
+		cursor = end > begin ? end : begin + 1;
+	}
+}
+
+size_t Searcher::getForwardStates() const
+{
+	return m_forward.empty() ? 0 : m_forward.dead;
+}
+
+size_t Searcher::getReverseStates() const
+{
+	return m_reverse.empty() ? 0 : m_reverse.dead;
+}
+
+const Prefilter& Searcher::getPrefilter() const
+{
+	return m_prefilter;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include<string>
+#include<unordered_map>
+#include<vector>
+
+#include "IndexedNfa.h"
+#include "Prefilter.h"
+#include "TransitionTable.h"
+
+struct SearchMatch
+{
+	size_t begin;
+	size_t end; // one past the last byte
+};
+
+// Finds every leftmost-longest, non-overlapping match inside a text buffer.
+//
+// One backward pass runs the reversed NFA's DFA unanchored (an implicit .* on
+// the right of the pattern) and records, for every offset, the set of NFA
+// states from which the rest of the text still reaches a match. The forward
+// pass only starts the anchored DFA where a match begins and stops it as soon
+// as no longer match is possible, so every byte is read once backward and at
+// most twice forward: linear in the buffer size.
+//
+// When every match has to start with a literal or with one of a few bytes,
+// the Prefilter jumps between candidate offsets and the anchored DFA is only
+// entered there. If verifying candidates costs too much, the rest of the
+// buffer falls back to the two passes.
+class Searcher
+{
+public:
+	Searcher() = default;
+	~Searcher() = default;
+
+	bool Compile(const std::string& regex, bool prefilter = true);
+
+	std::vector<SearchMatch> FindAll(const std::string& text);
+	void FindAll(const char* text, size_t length, std::vector<SearchMatch>& matches);
+
+	size_t getForwardStates() const;
+	size_t getReverseStates() const;
+	const Prefilter& getPrefilter() const;
+
+private:
+	static constexpr size_t kMaxLivePairs = 1 << 24;
+	static constexpr size_t kVerifyFactor = 4;
+	static constexpr size_t kVerifySlack = 1 << 16;
+
+	bool Live(int forward, int reverse);
+	size_t FindCandidates(const char* text, size_t length, std::vector<SearchMatch>& matches);
+	void FindTwoPass(const char* text, size_t length, size_t offset, std::vector<SearchMatch>& matches);
+
+	TransitionTable m_forward; // anchored, from the pattern's start
+	TransitionTable m_reverse; // unanchored, over the reversed NFA
+	std::vector<std::vector<int>> m_forward_subsets;
+	std::vector<std::vector<int>> m_reverse_subsets;
+	std::vector<signed char> m_live; // forward x reverse states: subsets intersect, -1 until computed
+	std::unordered_map<long long, bool> m_live_map; // instead of m_live when that would be too large
+	std::vector<int> m_reverse_at; // reverse DFA state at each offset of the last text
+	Prefilter m_prefilter;
+};
@@ -1,177 +1,270 @@
 ﻿#include<iostream>
 #include<fstream>
 #include<vector>
-#include<stack>
-#include<cstring>
 #include<format>
+#include<optional>
+#include<charconv>
+#include<cstdint>
+#include<cstring>
 
 #include "DeterministicFiniteAutomaton.h"
 #include "NondeterministicFiniteAutomaton.h"
+#include "Regex.h"
+#include "BatchValidator.h"
+#include "Matcher.h"
+#include "DfaFile.h"
+#include "Searcher.h"
+#include "ParallelMatcher.h"
+#include "CompilerContext.h"
+#include "NfaBuilder.h"
+
+// the whole of text as a number, or false
+template <typename T>
+bool parseLimit(const char* text, T& value)
+{
+    const char* end = text + std::strlen(text);
+    auto [rest, error] = std::from_chars(text, end, value);
+    return error == std::errc() && rest == end;
+}
 
-void readRegex(std::string file_name, std::string& regex)
+void printRegexError(const RegexParser& parser)
 {
-    std::ifstream f(file_name);
-    f >> regex;
-    f.close();
+    std::cout << std::format("REGEX is NOT valid! {} at offset {}\n", parser.getError(), parser.getErrorOffset());
 }
 
-void formatRegex(std::string& regex)
+bool compileRegexFile(const std::string& regex_file, DeterministicFiniteAutomaton& DFA)
 {
-    std::string regex_aux;
-    regex_aux += regex[0];
-    for (int i = 1; i < regex.size(); i++)
+    std::string regex;
+    readRegex(regex_file, regex);
+
+    CompilerContext context;
+    if (context.CompileDfa(regex, DFA) == false)
     {
-        if (strchr("()|.*", regex[i]) == 0 && strchr("()|.*", regex[i - 1]) == 0)
-        {
-            regex_aux += '.';
-        }
-        else if (strchr("()|.*", regex[i - 1]) == 0 && regex[i] == '(') {
-            regex_aux += '.';
-        }
-        else if ((regex[i - 1] == '*' || regex[i - 1] == ')') && strchr("()|.*", regex[i]) == 0) {
-            regex_aux += '.';
-        }
-        regex_aux += regex[i];
+        printRegexError(context.getParser());
+        return false;
     }
-    regex = regex_aux;
+
+    const MinimizationReport& report = DFA.getMinimizationReport();
+    const ConstructionTimings& timings = DFA.getConstructionTimings();
+    std::cout << std::format("DFA states: {} (before minimization: {})\n", report.statesAfter, report.statesBefore);
+    std::cout << std::format("Construction: closures {:.3f} ms, subsets {:.3f} ms, table {:.3f} ms, minimize {:.3f} ms\n",
+        timings.indexMs, timings.subsetMs, timings.tableMs, timings.minimizeMs);
+    return true;
 }
 
-bool verifyParenthesis(const std::string& regex)
+int runCompile(const std::string& regex_file, const std::string& dfa_file)
 {
-    std::stack<char> parenthesis;
+    DeterministicFiniteAutomaton DFA;
+    if (compileRegexFile(regex_file, DFA) == false)
+        return 1;
 
-    for (int i = 0; regex[i]; ++i)
+    if (DFA.SaveBinary(dfa_file) == false)
     {
-        if (regex[i] == '(')
-            parenthesis.emplace(regex[i]);
-        else if (regex[i] == ')')
-        {
-            if (parenthesis.empty())
-                return false;
-
-            parenthesis.pop();
-        }
+        std::cout << std::format("Cannot write {}!\n", dfa_file);
+        return 1;
     }
+    return 0;
+}
+
+int runEmit(const std::string& regex_file, const std::string& output_file, const std::string& function_name)
+{
+    DeterministicFiniteAutomaton DFA;
+    if (compileRegexFile(regex_file, DFA) == false)
+        return 1;
 
-    if (parenthesis.empty())
-        return true;
-    return false;
+    std::ofstream fout(output_file);
+    if (fout.is_open() == false)
+    {
+        std::cout << std::format("Cannot write {}!\n", output_file);
+        return 1;
+    }
+    DFA.EmitCpp(fout, function_name);
+    return 0;
 }
 
-bool verifyOperators(const std::string& regex)
+int runBatch(const std::string& regex_file, const std::string& words_file, const char* results_file)
 {
-    if (regex[0] == '|' || regex[regex.size() - 1] == '|' || regex[0] == '*')
+    // the regex file may also be a DFA saved with --compile, which is mapped instead of rebuilt
+    MappedDfa mapped;
+    DeterministicFiniteAutomaton DFA;
+    TransitionTableView table;
+    if (isDfaFile(regex_file))
     {
-        return false;
+        if (mapped.Open(regex_file) == false)
+        {
+            std::cout << std::format("Compiled DFA in {} is NOT valid!\n", regex_file);
+            return 1;
+        }
+        table = mapped.view();
+        std::cout << std::format("Loaded compiled DFA from {}\n", regex_file);
+    }
+    else
+    {
+        if (compileRegexFile(regex_file, DFA) == false)
+            return 1;
+        table = DFA.getTransitionTable().view();
     }
 
-    for (int i = 1; i < regex.size() - 1; ++i)
+    std::ofstream fout;
+    if (results_file)
     {
-        if (regex[i] == '|' && (strchr("()|*", regex[i - 1]) || strchr("()|*", regex[i + 1])))
-            return false;
-        else if (regex[i] == '*' && (regex[i - 1] == '(' || regex[i - 1] == '*'))
-            return false;
+        fout.open(results_file, std::ios::binary);
+        if (fout.is_open() == false)
+        {
+            std::cout << std::format("Cannot write {}!\n", results_file);
+            return 1;
+        }
     }
 
-    return true;
-}
+    BatchValidator validator(table);
+    BatchResult result;
+    if (validator.ValidateFile(words_file, results_file ? &fout : nullptr, result) == false)
+    {
+        std::cout << std::format("Cannot open {}!\n", words_file);
+        return 1;
+    }
+    if (results_file)
+    {
+        fout.close();
+        if (fout.fail())
+        {
+            std::cout << std::format("Cannot write {}!\n", results_file);
+            return 1;
+        }
+    }
 
-bool isValidRegex(const std::string& regex)
-{
-    return verifyParenthesis(regex) && verifyOperators(regex);
+    std::cout << std::format("Words: {}\nAccepted: {}\nRejected: {}\n", result.words, result.accepted, result.words - result.accepted);
+    std::cout << std::format("Time: {:.3f}s ({:.0f} words/sec)\n", result.seconds, result.seconds > 0 ? result.words / result.seconds : 0.0);
+    return 0;
 }
 
-int priority(char c)
+int runSearch(const std::string& regex_file, const std::string& text_file)
 {
+    std::string regex;
+    readRegex(regex_file, regex);
 
-    switch (c)
+    Searcher searcher;
+    if (searcher.Compile(regex) == false)
     {
-    case '(':
-        return 0;
-
-    case ')':
-        return 0;
+        std::cout << "REGEX is NOT valid!\n";
+        return 1;
+    }
 
-    case '|':
+    std::ifstream fin(text_file, std::ios::binary);
+    if (fin.is_open() == false)
+    {
+        std::cout << std::format("Cannot open {}!\n", text_file);
         return 1;
+    }
+    std::string text((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
 
-    case '.':
-        return 2;
+    std::vector<SearchMatch> matches;
+    searcher.FindAll(text.data(), text.size(), matches);
+    for (const SearchMatch& match : matches)
+        std::cout << std::format("{} {}\n", match.begin, match.end);
+    std::cout << std::format("Matches: {}\n", matches.size());
+    return 0;
+}
 
-    case '*':
-        return 3;
-    default:
-        return 0;
+int runCheck(const std::string& regex_file, const std::string& input_file)
+{
+    DeterministicFiniteAutomaton DFA;
+    if (compileRegexFile(regex_file, DFA) == false)
+        return 1;
+
+    std::ifstream fin(input_file, std::ios::binary);
+    if (fin.is_open() == false)
+    {
+        std::cout << std::format("Cannot open {}!\n", input_file);
+        return 1;
     }
+    std::string word((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+    ParallelMatcher matcher(DFA.getTransitionTable().view());
+    if (matcher.CheckWord(word))
+        std::cout << std::format("{} is a valid word!\n", input_file);
+    else
+        std::cout << std::format("{} is NOT a valid word!\n", input_file);
+    return 0;
 }
 
-std::vector<char> regexToPolishForm(std::string pattern)
+int main(int argc, char* argv[])
 {
-    std::vector<char> polish;
-    std::stack<char> op_stack;
+    // Tema1 --batch <regex or compiled DFA file> <words file> [results file]
+    if (argc >= 4 && std::string(argv[1]) == "--batch")
+        return runBatch(argv[2], argv[3], argc >= 5 ? argv[4] : nullptr);
+
+    // Tema1 --compile <regex file> <compiled DFA file>
+    if (argc >= 4 && std::string(argv[1]) == "--compile")
+        return runCompile(argv[2], argv[3]);
+
+    // Tema1 --emit <regex file> <output .cpp file> [function name]
+    if (argc >= 4 && std::string(argv[1]) == "--emit")
+        return runEmit(argv[2], argv[3], argc >= 5 ? argv[4] : "match");
+
+    // Tema1 --search <regex file> <text file>: offsets [begin, end) of every leftmost-longest match
+    if (argc >= 4 && std::string(argv[1]) == "--search")
+        return runSearch(argv[2], argv[3]);
 
-    for (int i = 0; pattern[i]; ++i)
+    // Tema1 --check <regex file> <input file>: the whole file is one word, matched on every core
+    if (argc >= 4 && std::string(argv[1]) == "--check")
+        return runCheck(argv[2], argv[3]);
+
+    // Tema1 [--engine <dfa|lazy|nfa|counting>] [--budget <max NFA states> <max DFA states> <max MB> <max ms>]
+    // counting keeps repetitions of single bytes as counters instead of copying them out;
+    // over budget, the dfa engine falls back to counting or nfa within the same limits; 0 leaves a limit out
+    MatchEngine engine = MatchEngine::Dfa;
+    CompileBudget budget;
+    for (int i = 1; i < argc; i++)
     {
-        if (isalnum(pattern[i]))
+        std::string option = argv[i];
+        if (option == "--engine" && i + 1 < argc)
         {
-            polish.push_back(pattern[i]);
+            if (parseMatchEngine(argv[++i], engine) == false)
+            {
+                std::cout << std::format("Unknown engine: {}\n", argv[i]);
+                return 1;
+            }
         }
-        else
+        else if (option == "--budget" && i + 4 < argc)
         {
-            if (pattern[i] == '(')
-                op_stack.push(pattern[i]);
-            else
+            size_t megabytes = 0;
+            if (parseLimit(argv[i + 1], budget.maxNfaStates) == false || parseLimit(argv[i + 2], budget.maxDfaStates) == false
+                || parseLimit(argv[i + 3], megabytes) == false || megabytes > (SIZE_MAX >> 20) || parseLimit(argv[i + 4], budget.maxMs) == false)
             {
-                if (pattern[i] == ')')
-                {
-                    while (!op_stack.empty() && op_stack.top() != '(')
-                    {
-                        polish.push_back(op_stack.top());
-                        op_stack.pop();
-                    }
-                    if (!op_stack.empty())
-                        op_stack.pop(); //scoate paranteza
-                }
-                else
-                {
-                    //daca expression[i] e operator
-                    while (!op_stack.empty() && priority(op_stack.top()) >= priority(pattern[i]))
-                    {
-                        polish.push_back(op_stack.top());
-                        op_stack.pop();
-                    }
-                    op_stack.push(pattern[i]);
-                }
+                std::cout << "Usage: --budget <max NFA states> <max DFA states> <max MB> <max ms>\n";
+                return 1;
             }
+            budget.maxBytes = megabytes << 20;
+            budget.fallback = true;
+            i += 4;
         }
     }
 
-    while (!op_stack.empty())
-    {
-        polish.push_back(op_stack.top());
-        op_stack.pop();
-    }
-
-    return polish;
-}
-
-int main()
-{
     std::string regex;
     readRegex("Input.txt",regex);
 
-    if (isValidRegex(regex) == false)
+    // the parser also takes '+', '?' and {m,n}, which the polish-form functions do not;
+    // the budget holds from the parse on, so an NFA over its state limit is never built
+    Matcher matcher(regex, engine, budget);
+    if (matcher.isRegexValid() == false)
     {
-        std::cout << "REGEX is NOT valid!\n";
+        printRegexError(matcher.getParser());
     }
     else
     {
+        if (matcher.getBudgetError().limit != BudgetLimit::None)
+            std::cout << std::format("Over budget: {}{}\n", matcher.getBudgetError().describe(),
+                matcher.isReady() == false ? "" : matcher.getEngine() == MatchEngine::CountingNfa ? ", matching with the counting NFA instead"
+                : ", matching with the NFA instead");
 
-        std::string formattedRegex = regex;
-        formatRegex(formattedRegex);
-        std::vector<char> polishForm = regexToPolishForm(formattedRegex);
-        NondeterministicFiniteAutomaton NFA = NFA.returnAFNfromPolishForm(polishForm);
-        DeterministicFiniteAutomaton DFA = DFA.AFNtoAFD(NFA);
+        // the DFA is checked once, when it is frozen: by the Matcher for the Dfa engine, here the first time it is needed otherwise
+        std::optional<bool> dfa_valid;
+        auto isDfaValid = [&]() {
+            if (!dfa_valid)
+                dfa_valid = matcher.getCompiledDfa() != nullptr || CompiledDfa::Freeze(matcher.getDfa()).has_value();
+            return *dfa_valid;
+        };
 
         bool exitState = false;
 
@@ -200,20 +293,44 @@ int main()
             }
             else if (state == 2) // Print DFA
             {
-                if (DFA.VerifyAutomation() == true)
+                if (matcher.getNfaGraph() == nullptr && matcher.getBudgetError().limit == BudgetLimit::None)
+                {
+                    std::cout << "The counting engine builds no DFA\n";
+                    continue;
+                }
+                // engines other than dfa determinize here, within the same budget
+                DeterministicFiniteAutomaton& DFA = matcher.getDfa();
+                if (matcher.getBudgetError().limit != BudgetLimit::None)
+                {
+                    std::cout << std::format("DFA is over budget: {}\n", matcher.getBudgetError().describe());
+                    continue;
+                }
+                if (isDfaValid() == true)
                 {
                     std::ofstream fout("OutputDFA.txt");
                     DFA.PrintAutomation(std::cout);
                     DFA.PrintAutomation(fout);
                     fout.close();
+
+                    const MinimizationReport& report = DFA.getMinimizationReport();
+                    std::cout << std::format("\nStates before minimization: {}\nStates after minimization: {}\n", report.statesBefore, report.statesAfter);
                 }
                 else
                     std::cout << std::endl << "DFA is NOT valid!" << std::endl;
             }
             else if (state == 3) // Print NFA
             {
-                if (DFA.VerifyAutomation() == true)
+                if (matcher.getNfaGraph() == nullptr)
+                {
+                    if (matcher.getBudgetError().limit != BudgetLimit::None)
+                        std::cout << std::format("NFA is over budget: {}\n", matcher.getBudgetError().describe());
+                    else
+                        std::cout << "The counting engine builds no NFA\n";
+                    continue;
+                }
+                if (matcher.getEngine() != MatchEngine::Dfa || isDfaValid() == true)
                 {
+                    NondeterministicFiniteAutomaton NFA = NfaBuilder::ToAutomaton(*matcher.getNfaGraph());
                     std::ofstream fout("OutputNFA.txt");
                     NFA.PrintAutomation(std::cout);
                     NFA.PrintAutomation(fout);
@@ -228,9 +345,11 @@ int main()
                 std::cout << "Enter word for validation: ";
                 std::cin >> word;
 
-                if (DFA.VerifyAutomation() == true)
+                if (matcher.isReady() == false)
+                    std::cout << std::format("Over budget: {}\n", matcher.getBudgetError().describe());
+                else if (matcher.getEngine() != MatchEngine::Dfa || isDfaValid() == true)
                 {
-                    if (DFA.CheckWord(word) == true)
+                    if (matcher.CheckWord(word) == true)
                     {
                         std::cout << std::format("{} is a valid word!\n", word);
                     }
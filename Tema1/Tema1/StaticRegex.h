@@ -0,0 +1,336 @@
+#pragma once
+
+#include<algorithm>
+#include<array>
+#include<cstddef>
+#include<string_view>
+#include<vector>
+
+#include "TransitionTable.h"
+
+// A regex given as a string literal, compiled entirely at compile time:
+//
+//   using Identifier = StaticRegex<"(a|b)(a|b|0|1)*">;
+//   Identifier::CheckWord(word);
+//
+// The pipeline mirrors the runtime one (isValidRegex, formatRegex,
+// regexToPolishForm, Thompson construction, subset construction) on
+// transient constexpr vectors, and the result is a static constexpr dense
+// table laid out like TransitionTable. Nothing runs at startup and the
+// matching loop inlines into the caller.
+
+template <size_t N>
+struct FixedString
+{
+	char value[N]{};
+
+	constexpr FixedString(const char(&text)[N])
+	{
+		std::copy_n(text, N, value);
+	}
+
+	constexpr std::string_view view() const
+	{
+		return { value, N - 1 };
+	}
+};
+
+namespace static_regex
+{
+	constexpr bool isOperator(char c)
+	{
+		return c == '(' || c == ')' || c == '|' || c == '.' || c == '*';
+	}
+
+	constexpr bool isSymbol(char c)
+	{
+		return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+	}
+
+	// isValidRegex, plus: non-empty and every symbol alphanumeric. The wildcard and
+	// character classes are runtime-only; '.' is kept here for explicit concatenation.
+	constexpr bool isValid(std::string_view regex)
+	{
+		if (regex.empty())
+			return false;
+
+		int depth = 0;
+		for (char c : regex) {
+			if (c == '(')
+				depth++;
+			else if (c == ')' && --depth < 0)
+				return false;
+			else if (c == '.' || (!isOperator(c) && !isSymbol(c)))
+				return false;
+		}
+		if (depth != 0)
+			return false;
+
+		if (regex.front() == '|' || regex.back() == '|' || regex.front() == '*')
+			return false;
+		for (size_t i = 1; i + 1 < regex.size(); i++) {
+			std::string_view around = "()|*";
+			if (regex[i] == '|' && (around.find(regex[i - 1]) != around.npos || around.find(regex[i + 1]) != around.npos))
+				return false;
+			if (regex[i] == '*' && (regex[i - 1] == '(' || regex[i - 1] == '*'))
+				return false;
+		}
+		return true;
+	}
+
+	// formatRegex: explicit '.' between implicitly concatenated operands
+	constexpr std::vector<char> format(std::string_view regex)
+	{
+		std::vector<char> formatted = { regex[0] };
+		for (size_t i = 1; i < regex.size(); i++) {
+			char previous = regex[i - 1], current = regex[i];
+			if (!isOperator(previous) && (!isOperator(current) || current == '('))
+				formatted.push_back('.');
+			else if ((previous == '*' || previous == ')') && (!isOperator(current) || current == '('))
+				formatted.push_back('.');
+			formatted.push_back(current);
+		}
+		return formatted;
+	}
+
+	constexpr int priority(char c)
+	{
+		return c == '|' ? 1 : c == '.' ? 2 : c == '*' ? 3 : 0;
+	}
+
+	// regexToPolishForm
+	constexpr std::vector<char> polishForm(const std::vector<char>& pattern)
+	{
+		std::vector<char> polish, operators;
+		for (char c : pattern) {
+			if (isSymbol(c))
+				polish.push_back(c);
+			else if (c == '(')
+				operators.push_back(c);
+			else if (c == ')') {
+				while (!operators.empty() && operators.back() != '(') {
+					polish.push_back(operators.back());
+					operators.pop_back();
+				}
+				if (!operators.empty())
+					operators.pop_back();
+			}
+			else {
+				while (!operators.empty() && priority(operators.back()) >= priority(c)) {
+					polish.push_back(operators.back());
+					operators.pop_back();
+				}
+				operators.push_back(c);
+			}
+		}
+		polish.insert(polish.end(), operators.rbegin(), operators.rend());
+		return polish;
+	}
+
+	struct Edge
+	{
+		int from;
+		int symbol; // -1 for lambda
+		int to;
+	};
+
+	struct Nfa
+	{
+		int stateCount = 0;
+		int start = 0;
+		int accept = 0;
+		std::vector<Edge> edges;
+	};
+
+	// Thompson construction
+	constexpr Nfa thompson(const std::vector<char>& polish)
+	{
+		struct Fragment
+		{
+			int start;
+			int end;
+		};
+
+		Nfa nfa;
+		std::vector<Fragment> stack;
+		auto fragment = [&nfa]() {
+			nfa.stateCount += 2;
+			return Fragment{ nfa.stateCount - 2, nfa.stateCount - 1 };
+		};
+
+		for (char c : polish) {
+			if (c == '*') {
+				Fragment a = stack.back();
+				Fragment result = fragment();
+				nfa.edges.push_back({ result.start, -1, a.start });
+				nfa.edges.push_back({ a.end, -1, result.end });
+				nfa.edges.push_back({ result.start, -1, result.end });
+				nfa.edges.push_back({ a.end, -1, a.start });
+				stack.back() = result;
+			}
+			else if (c == '.' || c == '|') {
+				Fragment b = stack.back();
+				stack.pop_back();
+				Fragment a = stack.back();
+				if (c == '.') {
+					nfa.edges.push_back({ a.end, -1, b.start });
+					stack.back() = { a.start, b.end };
+				}
+				else {
+					Fragment result = fragment();
+					nfa.edges.push_back({ result.start, -1, a.start });
+					nfa.edges.push_back({ result.start, -1, b.start });
+					nfa.edges.push_back({ a.end, -1, result.end });
+					nfa.edges.push_back({ b.end, -1, result.end });
+					stack.back() = result;
+				}
+			}
+			else {
+				Fragment result = fragment();
+				nfa.edges.push_back({ result.start, (unsigned char)c, result.end });
+				stack.push_back(result);
+			}
+		}
+
+		nfa.start = stack.back().start;
+		nfa.accept = stack.back().end;
+		return nfa;
+	}
+
+	struct Dfa
+	{
+		int stateCount = 0;
+		int columnCount = 0; // alphabet + the column of every other byte
+		std::array<int, 256> columns{};
+		std::vector<int> next; // (stateCount + 1) x columnCount, row stateCount is dead
+		std::vector<unsigned char> accepting;
+	};
+
+	constexpr void closure(const Nfa& nfa, std::vector<int>& subset)
+	{
+		std::vector<int> stack = subset;
+		while (!stack.empty()) {
+			int state = stack.back();
+			stack.pop_back();
+			for (const Edge& edge : nfa.edges)
+				if (edge.from == state && edge.symbol == -1 && std::find(subset.begin(), subset.end(), edge.to) == subset.end()) {
+					subset.push_back(edge.to);
+					stack.push_back(edge.to);
+				}
+		}
+		std::sort(subset.begin(), subset.end());
+	}
+
+	// subset construction, states numbered in discovery order from 0
+	constexpr Dfa determinize(std::string_view regex)
+	{
+		Nfa nfa = thompson(polishForm(format(regex)));
+
+		Dfa dfa;
+		std::vector<int> alphabet;
+		for (const Edge& edge : nfa.edges)
+			if (edge.symbol != -1 && std::find(alphabet.begin(), alphabet.end(), edge.symbol) == alphabet.end())
+				alphabet.push_back(edge.symbol);
+		std::sort(alphabet.begin(), alphabet.end());
+		dfa.columnCount = (int)alphabet.size() + 1;
+		dfa.columns.fill((int)alphabet.size());
+		for (int column = 0; column < (int)alphabet.size(); column++)
+			dfa.columns[alphabet[column]] = column;
+
+		std::vector<std::vector<int>> subsets = { { nfa.start } };
+		closure(nfa, subsets[0]);
+		std::vector<int> next;
+		for (size_t current = 0; current < subsets.size(); current++)
+			for (int symbol : alphabet) {
+				std::vector<int> target;
+				for (const Edge& edge : nfa.edges)
+					if (edge.symbol == symbol && std::find(subsets[current].begin(), subsets[current].end(), edge.from) != subsets[current].end()
+						&& std::find(target.begin(), target.end(), edge.to) == target.end())
+						target.push_back(edge.to);
+				if (target.empty()) {
+					next.push_back(-1);
+					continue;
+				}
+				closure(nfa, target);
+				auto found = std::find(subsets.begin(), subsets.end(), target);
+				next.push_back((int)(found - subsets.begin()));
+				if (found == subsets.end())
+					subsets.push_back(target);
+			}
+
+		dfa.stateCount = (int)subsets.size();
+		int dead = dfa.stateCount;
+		dfa.next.assign((size_t)(dfa.stateCount + 1) * dfa.columnCount, dead);
+		dfa.accepting.assign(dfa.stateCount + 1, 0);
+		for (int state = 0; state < dfa.stateCount; state++) {
+			for (int column = 0; column < (int)alphabet.size(); column++) {
+				int target = next[(size_t)state * alphabet.size() + column];
+				if (target != -1)
+					dfa.next[(size_t)state * dfa.columnCount + column] = target;
+			}
+			dfa.accepting[state] = std::find(subsets[state].begin(), subsets[state].end(), nfa.accept) != subsets[state].end();
+		}
+		return dfa;
+	}
+
+	struct Shape
+	{
+		size_t states;
+		size_t columns;
+	};
+
+	constexpr Shape measure(std::string_view regex)
+	{
+		if (!isValid(regex))
+			return { 0, 1 };
+		Dfa dfa = determinize(regex);
+		return { (size_t)dfa.stateCount, (size_t)dfa.columnCount };
+	}
+}
+
+template <FixedString Pattern>
+class StaticRegex
+{
+public:
+	static constexpr bool kValid = static_regex::isValid(Pattern.view());
+	static_assert(kValid, "StaticRegex: the pattern is NOT a valid regex");
+
+	// measured once; the table below has to determinize again, as the transient Dfa cannot outlive its constant expression
+	static constexpr static_regex::Shape kShape = static_regex::measure(Pattern.view());
+	static constexpr size_t kStates = kShape.states;
+	static constexpr size_t kColumns = kShape.columns;
+
+	struct Table
+	{
+		std::array<int, (kStates + 1) * kColumns> next{}; // row kStates is the dead state
+		std::array<int, 256> columns{};
+		std::array<unsigned char, kStates + 1> accepting{};
+	};
+
+	static constexpr Table kTable = []() {
+		Table table;
+		if constexpr (kValid) {
+			static_regex::Dfa dfa = static_regex::determinize(Pattern.view());
+			std::copy(dfa.next.begin(), dfa.next.end(), table.next.begin());
+			table.columns = dfa.columns;
+			std::copy(dfa.accepting.begin(), dfa.accepting.end(), table.accepting.begin());
+		}
+		return table;
+	}();
+
+	static constexpr bool CheckWord(std::string_view word)
+	{
+		size_t state = 0;
+		for (char symbol : word) {
+			state = kTable.next[state * kColumns + kTable.columns[(unsigned char)symbol]];
+			if (state == kStates)
+				return false;
+		}
+		return kTable.accepting[state];
+	}
+
+	static TransitionTableView view()
+	{
+		return { kTable.next.data(), kTable.columns.data(), kTable.accepting.data(), (int)kColumns, 0, (int)kStates };
+	}
+};
@@ -0,0 +1,39 @@
+#include "StreamMatcher.h"
+
+StreamMatcher::StreamMatcher(TransitionTableView table)
+	: m_table(table), m_state(table.start)
+{
+}
+
+bool StreamMatcher::Feed(const char* chunk, size_t length)
+{
+	int state = m_state;
+	size_t i = 0;
+	while (i < length && state != m_table.dead)
+		state = m_table.step(state, (unsigned char)chunk[i++]);
+
+	m_state = state;
+	m_consumed += i;
+	return state != m_table.dead;
+}
+
+void StreamMatcher::Reset()
+{
+	m_state = m_table.start;
+	m_consumed = 0;
+}
+
+bool StreamMatcher::isAccepting() const
+{
+	return m_table.accepting[m_state];
+}
+
+bool StreamMatcher::isDead() const
+{
+	return m_state == m_table.dead;
+}
+
+size_t StreamMatcher::getConsumed() const
+{
+	return m_consumed;
+}
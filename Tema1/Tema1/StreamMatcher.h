@@ -0,0 +1,30 @@
+#pragma once
+
+#include<cstddef>
+
+#include "TransitionTable.h"
+
+// Matches one word that arrives in pieces: Feed each chunk as it comes, in
+// place, and ask isAccepting once the word is complete. Only the current DFA
+// state is kept between chunks, so a token split across buffers needs no
+// copying and nothing is allocated. Once the state is dead no continuation can
+// match and Feed returns right away.
+class StreamMatcher
+{
+public:
+	explicit StreamMatcher(TransitionTableView table);
+	~StreamMatcher() = default;
+
+	// false once the input so far cannot be extended into a match
+	bool Feed(const char* chunk, size_t length);
+	void Reset();
+
+	bool isAccepting() const;
+	bool isDead() const;
+	size_t getConsumed() const; // bytes fed before the state died, or all of them
+
+private:
+	TransitionTableView m_table;
+	int m_state;
+	size_t m_consumed = 0;
+};
@@ -0,0 +1,69 @@
+#include<algorithm>
+
+#include "TransitionTable.h"
+
+namespace
+{
+	// bytes per lockstep round; a lane that died is only noticed between rounds
+	constexpr size_t kRound = 64;
+	// idle lanes read these from the dead state, which never leaves it
+	const unsigned char kIdle[kRound] = {};
+	constexpr size_t kNoWord = (size_t)-1;
+}
+
+void TransitionTableView::CheckWords(std::span<const std::string_view> words, std::vector<uint64_t>& accepted) const
+{
+	accepted.assign((words.size() + 63) / 64, 0);
+
+	const unsigned char* position[kStreams];
+	size_t left[kStreams];
+	int state[kStreams];
+	size_t word_of[kStreams];
+	size_t taken = 0;
+	int busy = 0;
+
+	// puts the next non-empty word on a lane, or parks it; empty words only need the start state
+	auto load = [&](int lane) {
+		for (; taken < words.size() && words[taken].empty(); taken++)
+			if (accepting[start])
+				accepted[taken / 64] |= 1ull << (taken % 64);
+		if (taken == words.size()) {
+			position[lane] = kIdle;
+			left[lane] = kNoWord;
+			state[lane] = dead;
+			word_of[lane] = kNoWord;
+			return false;
+		}
+		position[lane] = (const unsigned char*)words[taken].data();
+		left[lane] = words[taken].size();
+		state[lane] = start;
+		word_of[lane] = taken++;
+		return true;
+	};
+
+	for (int lane = 0; lane < kStreams; lane++)
+		busy += load(lane);
+
+	while (busy > 0) {
+		size_t round = kRound;
+		for (int lane = 0; lane < kStreams; lane++)
+			round = std::min(round, left[lane]);
+
+		for (size_t i = 0; i < round; i++)
+			for (int lane = 0; lane < kStreams; lane++)
+				state[lane] = next[state[lane] * columnCount + columns[*position[lane]++]];
+
+		for (int lane = 0; lane < kStreams; lane++) {
+			if (word_of[lane] == kNoWord) {
+				position[lane] = kIdle;
+				continue;
+			}
+			left[lane] -= round;
+			if (left[lane] != 0 && state[lane] != dead)
+				continue;
+			if (left[lane] == 0 && accepting[state[lane]])
+				accepted[word_of[lane] / 64] |= 1ull << (word_of[lane] % 64);
+			busy -= !load(lane);
+		}
+	}
+}
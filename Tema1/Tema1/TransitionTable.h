@@ -0,0 +1,73 @@
+#pragma once
+
+#include<array>
+#include<cstddef>
+#include<cstdint>
+#include<span>
+#include<string_view>
+#include<vector>
+
+// Non-owning view of a dense table, either a TransitionTable or one mapped from a file.
+struct TransitionTableView
+{
+	const int* next = nullptr;
+	const int* columns = nullptr;
+	const unsigned char* accepting = nullptr;
+	int columnCount = 0;
+	int start = 0;
+	int dead = 0;
+
+	int step(int state, unsigned char symbol) const
+	{
+		return next[state * columnCount + columns[symbol]];
+	}
+
+	bool CheckWord(const char* word, size_t length) const
+	{
+		int current_state = start;
+		for (size_t i = 0; i < length; i++) {
+			current_state = step(current_state, (unsigned char)word[i]);
+			if (current_state == dead)
+				return false;
+		}
+		return accepting[current_state];
+	}
+
+	// CheckWord for many words at once: kStreams words advance through the table
+	// in lockstep, so their independent lookups overlap instead of each waiting
+	// on the previous one. Bit i % 64 of accepted[i / 64] is word i's verdict.
+	static constexpr int kStreams = 8;
+	void CheckWords(std::span<const std::string_view> words, std::vector<uint64_t>& accepted) const;
+};
+
+struct TransitionTable
+{
+	std::vector<int> next; // (states + 1) x columns, row `dead` is the sink
+	std::array<int, 256> columns{}; // byte -> column
+	std::vector<unsigned char> accepting;
+	int columnCount = 0;
+	int start = 0;
+	int dead = 0;
+
+	bool empty() const
+	{
+		return next.empty();
+	}
+
+	void clear()
+	{
+		next.clear();
+		accepting.clear();
+		columnCount = 0;
+	}
+
+	int step(int state, unsigned char symbol) const
+	{
+		return next[state * columnCount + columns[symbol]];
+	}
+
+	TransitionTableView view() const
+	{
+		return { next.data(), columns.data(), accepting.data(), columnCount, start, dead };
+	}
+};